@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+// https://www.3dkingdoms.com/checkers/bitboards.htm
+// https://www.chessprogramming.org/General_Setwise_Operations
+
+/*
+    Bit i represents the square with index i, in the range [0, 31]
+
+    Rows are numbered from 0 (black's side) to 7 (white's side)
+    On even rows the squares are shifted one column to the right, on odd rows they are not
+
+      0   1   2   3
+    4   5   6   7
+      8   9  10  11
+    ...
+*/
+
+namespace bitboard {
+    using Bitboard = std::uint32_t;
+
+    enum class Direction {
+        NorthEast,
+        NorthWest,
+        SouthEast,
+        SouthWest
+    };
+
+    inline constexpr Bitboard EMPTY {0x00000000u};
+
+    inline constexpr Bitboard EVEN_ROWS {0x0F0F0F0Fu};
+    inline constexpr Bitboard ODD_ROWS {0xF0F0F0F0u};
+    inline constexpr Bitboard LEFT_COLUMN {0x11111111u};  // Only squares on odd rows are really on the edge
+    inline constexpr Bitboard RIGHT_COLUMN {0x88888888u};  // Only squares on even rows are really on the edge
+
+    constexpr Bitboard bit(int index) noexcept {
+        assert(index >= 0 && index < 32);
+
+        return static_cast<Bitboard>(1u) << index;
+    }
+
+    // Move every square one step in that direction; squares that fall off the board are discarded
+    template<Direction Dir>
+    constexpr Bitboard shift(Bitboard bitboard) noexcept {
+        switch (Dir) {
+            case Direction::NorthEast:
+                return (bitboard & EVEN_ROWS & ~RIGHT_COLUMN) >> 3 | (bitboard & ODD_ROWS) >> 4;
+            case Direction::NorthWest:
+                return (bitboard & EVEN_ROWS) >> 4 | (bitboard & ODD_ROWS & ~LEFT_COLUMN) >> 5;
+            case Direction::SouthEast:
+                return (bitboard & EVEN_ROWS & ~RIGHT_COLUMN) << 5 | (bitboard & ODD_ROWS) << 4;
+            case Direction::SouthWest:
+                return (bitboard & EVEN_ROWS) << 4 | (bitboard & ODD_ROWS & ~LEFT_COLUMN) << 3;
+        }
+
+        return EMPTY;
+    }
+
+    template<Direction Dir>
+    constexpr Direction opposite() noexcept {
+        switch (Dir) {
+            case Direction::NorthEast:
+                return Direction::SouthWest;
+            case Direction::NorthWest:
+                return Direction::SouthEast;
+            case Direction::SouthEast:
+                return Direction::NorthWest;
+            case Direction::SouthWest:
+                return Direction::NorthEast;
+        }
+
+        return Dir;
+    }
+
+    inline int pop_count(Bitboard bitboard) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return static_cast<int>(__popcnt(bitboard));
+#else
+        return __builtin_popcount(bitboard);
+#endif
+    }
+
+    inline int index(Bitboard bitboard) noexcept {
+        // The index of the least significant bit
+        // The bitboard must not be empty
+
+        assert(bitboard != EMPTY);
+
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long result;
+        _BitScanForward(&result, bitboard);
+        return static_cast<int>(result);
+#else
+        return __builtin_ctz(bitboard);
+#endif
+    }
+
+    inline int pop_index(Bitboard& bitboard) noexcept {
+        // Remove the least significant bit and return its index
+
+        const int result {index(bitboard)};
+        bitboard &= bitboard - 1u;
+
+        return result;
+    }
+}
@@ -20,6 +20,17 @@ namespace commands {
         return std::next(iter);
     }
 
+    // The value following the name, if both are present
+    static std::optional<std::string> named_argument(const std::vector<std::string>& tokens, const std::string& name) {
+        if (const auto iter {token_available(tokens, name)}; iter != tokens.cend()) {
+            if (const auto next_iter {next_token(iter)}; next_iter != tokens.cend()) {
+                return *next_iter;
+            }
+        }
+
+        return std::nullopt;
+    }
+
     static std::optional<std::vector<std::string>> parse_setup_moves(const std::vector<std::string>& tokens) {
         std::size_t index {2};
         std::vector<std::string> setup_moves;
@@ -59,33 +70,40 @@ namespace commands {
     }
 
     void go(engine::Engine& engine, const std::vector<std::string>& tokens) {
-        std::optional<std::string> max_depth;
-        std::optional<std::string> max_time;
-        bool dont_play_move {false};
+        engine::GoArguments arguments;
 
-        if (const auto iter {token_available(tokens, "maxdepth")}; iter != tokens.cend()) {
-            if (const auto next_iter {next_token(iter)}; next_iter != tokens.cend()) {
-                max_depth = *next_iter;
-            }
+        arguments.max_depth = named_argument(tokens, "maxdepth");
+        arguments.max_time = named_argument(tokens, "maxtime");
+        arguments.black_time = named_argument(tokens, "btime");
+        arguments.white_time = named_argument(tokens, "wtime");
+        arguments.black_increment = named_argument(tokens, "binc");
+        arguments.white_increment = named_argument(tokens, "winc");
+        arguments.moves_to_go = named_argument(tokens, "movestogo");
+        arguments.nodes = named_argument(tokens, "nodes");
+
+        if (const auto iter {token_available(tokens, "dontplaymove")}; iter != tokens.cend()) {
+            arguments.dont_play_move = true;
         }
 
-        if (const auto iter {token_available(tokens, "maxtime")}; iter != tokens.cend()) {
-            if (const auto next_iter {next_token(iter)}; next_iter != tokens.cend()) {
-                max_time = *next_iter;
-            }
+        if (const auto iter {token_available(tokens, "ponder")}; iter != tokens.cend()) {
+            arguments.ponder = true;
         }
 
-        if (const auto iter {token_available(tokens, "dontplaymove")}; iter != tokens.cend()) {
-            dont_play_move = true;
+        if (const auto iter {token_available(tokens, "infinite")}; iter != tokens.cend()) {
+            arguments.infinite = true;
         }
 
-        engine.go(max_depth, max_time, dont_play_move);
+        engine.go(arguments);
     }
 
     void stop(engine::Engine& engine, const std::vector<std::string>&) {
         engine.stop();
     }
 
+    void ponderhit(engine::Engine& engine, const std::vector<std::string>&) {
+        engine.ponderhit();
+    }
+
     void getparameters(engine::Engine& engine, const std::vector<std::string>&) {
         engine.getparameters();
     }
@@ -117,4 +135,14 @@ namespace commands {
     void board(engine::Engine& engine, const std::vector<std::string>&) {
         engine.board();
     }
+
+    void perft(engine::Engine& engine, const std::vector<std::string>& tokens) {
+        if (!token_available(tokens, 1)) {
+            throw error::InvalidCommand();
+        }
+
+        const bool divide {token_available(tokens, "divide") != tokens.cend()};
+
+        engine.perft(tokens.at(1), divide);
+    }
 }
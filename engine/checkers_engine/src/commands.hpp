@@ -11,10 +11,12 @@ namespace commands {
     void move(engine::Engine& engine, const std::vector<std::string>& tokens);
     void go(engine::Engine& engine, const std::vector<std::string>& tokens);
     void stop(engine::Engine& engine, const std::vector<std::string>&);
+    void ponderhit(engine::Engine& engine, const std::vector<std::string>&);
     void getparameters(engine::Engine& engine, const std::vector<std::string>&);
     void setparameter(engine::Engine& engine, const std::vector<std::string>& tokens);
     void getparameter(engine::Engine& engine, const std::vector<std::string>& tokens);
     void quit(engine::Engine& engine, const std::vector<std::string>&);
     void getname(engine::Engine& engine, const std::vector<std::string>&);
     void board(engine::Engine& engine, const std::vector<std::string>&);
+    void perft(engine::Engine& engine, const std::vector<std::string>& tokens);
 }
@@ -1,6 +1,12 @@
 #include "engine.hpp"
 
 #include <utility>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
 #include <limits>
 #include <unordered_map>
 #include <cstring>
@@ -12,6 +18,9 @@
 #include "search.hpp"
 #include "error.hpp"
 #include "zobrist.hpp"
+#include "perft.hpp"
+#include "memory.hpp"
+#include "frozen_parameters.hpp"
 
 // https://en.cppreference.com/w/cpp/thread/condition_variable
 
@@ -23,6 +32,14 @@
 namespace engine {
     static const char* START_POSITION {"B:B1,2,3,4,5,6,7,8,9,10,11,12:W21,22,23,24,25,26,27,28,29,30,31,32"};
 
+    // In MiB; used when the memory can't be determined
+    static constexpr std::size_t DEFAULT_HASH_SIZE {512};
+
+    // In MiB; a bigger table doesn't help at the depths reached in a game
+    static constexpr std::size_t MAX_AUTO_HASH_SIZE {1024};
+
+    static constexpr int MAX_THREADS {256};
+
     static const char* OPENING_BOOK {
         "B:B1,2,3,4,5,6,7,8,9,10,11,12:W21,22,23,24,25,26,27,28,29,30,31,32 11-16 09-14 09-13 11-15 12-16 10-14 10-15\n"
         "W:B1,2,3,4,5,6,7,8,10,11,12,13:W21,22,23,24,25,26,27,28,29,30,31,32 21-17 24-19 22-17 23-18 24-20 22-18 23-19\n"
@@ -110,6 +127,24 @@ namespace engine {
         return result;
     }
 
+    static std::size_t transposition_table_size(int hash_size, float hash_ratio) {
+        // Size in MiB, or automatic, if 0
+
+        if (hash_size > 0) {
+            return transposition_table::mib_to_bytes(static_cast<std::size_t>(hash_size));
+        }
+
+        const auto memory {memory::available_memory()};
+
+        if (!memory) {
+            return transposition_table::mib_to_bytes(DEFAULT_HASH_SIZE);
+        }
+
+        const auto size {static_cast<std::size_t>(static_cast<double>(*memory) * std::clamp(hash_ratio, 0.0f, 1.0f))};
+
+        return std::min(size, transposition_table::mib_to_bytes(MAX_AUTO_HASH_SIZE));
+    }
+
     static int parse_int(const std::string& string) {
         try {
             return std::stoi(string);
@@ -120,6 +155,16 @@ namespace engine {
         }
     }
 
+    static std::int64_t parse_int64(const std::string& string) {
+        try {
+            return std::stoll(string);
+        } catch (const std::invalid_argument&) {
+            throw error::InvalidCommand();
+        } catch (const std::out_of_range&) {
+            throw error::InvalidCommand();
+        }
+    }
+
     static float parse_float(const std::string& string) {
         try {
             return std::stof(string);
@@ -150,15 +195,43 @@ namespace engine {
         }
     }
 
+    static time_manager::Limits parse_time_limits(const GoArguments& arguments, game::Player player) {
+        time_manager::Limits limits;
+
+        if (arguments.max_time) {
+            limits.max_time = parse_double(*arguments.max_time);
+        }
+
+        // Only the clock of the player to move matters
+        const auto& time {player == game::Player::Black ? arguments.black_time : arguments.white_time};
+        const auto& increment {player == game::Player::Black ? arguments.black_increment : arguments.white_increment};
+
+        if (time) {
+            time_manager::Clock clock;
+            clock.time = parse_double(*time);
+            clock.increment = increment ? parse_double(*increment) : 0.0;
+            clock.moves_to_go = arguments.moves_to_go ? parse_int(*arguments.moves_to_go) : 0;
+
+            limits.clock = clock;
+        }
+
+        if (arguments.nodes) {
+            limits.nodes = parse_int64(*arguments.nodes);
+        }
+
+        return limits;
+    }
+
     void Engine::init() {
         ignore_invalid_command_on_init(true);
 
-        try {
-            // TT is empty by default
-            m_transposition_table.allocate(transposition_table::mib_to_bytes(750));
-        } catch (const std::bad_alloc&) {
-            throw error::Fatal();
-        }
+        // Parameters must have default values at this stage
+        initialize_parameters();
+
+        // TT is empty by default
+        resize_transposition_table();
+
+        setup_thread_pool();
 
         m_running = true;
 
@@ -174,13 +247,32 @@ namespace engine {
 
                 // Do the actual work now
                 // Search returns a valid result or nothing, if the game is over
-                const game::Move best_move {search_move(lock)};
+                game::Move ponder_move {game::NULL_MOVE};
+                const game::Move best_move {search_move(lock, ponder_move)};
+
+                lock.lock();
+
+                if (m_ponder) {
+                    // The opponent didn't play the expected reply; take it back and discard the search
+                    m_ponder = false;
+
+                    m_position = m_previous_positions.back();
+                    m_previous_positions.pop_back();
+                    m_moves_played.pop_back();
+
+                    m_search = false;
+                    m_cv.notify_all();
+
+                    continue;
+                }
 
                 if (!m_search_options.dont_play_move && best_move != game::NULL_MOVE) {
                     m_previous_positions.push_back(m_position);
                     m_moves_played.push_back(best_move);
 
                     game::play_move(m_position, best_move);
+
+                    m_ponder_move = ponder_move;
                 }
 
                 // Reset the search flag as a signal for the cv; the lock is still being held
@@ -188,13 +280,10 @@ namespace engine {
 
                 // Message the GUI only now, to indicate that we are ready for another GO
                 // Best move is already something or nothing
-                messages::bestmove(best_move);
+                messages::bestmove(best_move, m_ponder_move);
             }
         });
 
-        // Parameters must have default values at this stage
-        initialize_parameters();
-
         // Zobrist hash is static
         zobrist::instance.initialize();
 
@@ -211,6 +300,8 @@ namespace engine {
         // Don't share data between games
         m_transposition_table.clear();
 
+        m_ponder_move = game::NULL_MOVE;
+
         // Resetting the sequence is not really important, but it's a good idea
         m_search_sequence = 0;
 
@@ -244,6 +335,8 @@ namespace engine {
     void Engine::move(const std::string& move) {
         ignore_invalid_command_on_init();
 
+        m_ponder_move = game::NULL_MOVE;
+
         // State needs to be restored in case of error
         auto backup_previous_positions {m_previous_positions};
         auto backup_moves_played {m_moves_played};
@@ -260,25 +353,51 @@ namespace engine {
         }
     }
 
-    void Engine::go(const std::optional<std::string>& max_depth, const std::optional<std::string>& max_time, bool dont_play_move) {
+    void Engine::go(const GoArguments& arguments) {
         ignore_invalid_command_on_init();
 
         if (m_search) {
             throw error::InvalidCommand();
         }
 
-        // Set the options before every search
-        m_search_options.max_depth = max_depth ? parse_int(*max_depth) : game::MAX_DEPTH;
-        m_search_options.max_time = max_time ? parse_double(*max_time) : std::numeric_limits<double>::max();
-        m_search_options.dont_play_move = dont_play_move;
+        // Pondering needs an expected reply to play
+        if (arguments.ponder && m_ponder_move == game::NULL_MOVE) {
+            throw error::InvalidCommand();
+        }
+
+        // When pondering, the engine will be the one to move
+        const game::Player player {arguments.ponder ? game::opponent(m_position.player) : m_position.player};
 
-        if (std::get<2>(m_parameters.at("use_book"))) {
+        // Set the options before every search; an infinite search ignores any limit
+        m_search_options.max_depth = arguments.max_depth && !arguments.infinite ? parse_int(*arguments.max_depth) : game::MAX_DEPTH;
+        m_search_options.limits = arguments.infinite ? time_manager::Limits() : parse_time_limits(arguments, player);
+        m_search_options.dont_play_move = arguments.dont_play_move;
+        m_search_options.infinite = arguments.infinite;
+
+        // The expected reply belongs only to the position right after the last BESTMOVE, book moves included
+        const game::Move ponder_move {m_ponder_move};
+        m_ponder_move = game::NULL_MOVE;
+
+        if (arguments.ponder) {
+            // Play the expected reply; it's taken back on a ponder miss
+            m_previous_positions.push_back(m_position);
+            m_moves_played.push_back(ponder_move);
+
+            game::play_move(m_position, ponder_move);
+
+            m_ponder = true;
+        } else if (std::get<2>(m_parameters.at("use_book")) && !arguments.infinite) {
             // First consult the opening book
             if (lookup_book()) {
                 return;
             }
         }
 
+        // The search is not running, so the TT and the threads can be safely reallocated, if needed
+        resize_transposition_table();
+        setup_thread_pool();
+        setup_evaluation_caches();
+
         // Set the search flag; it's a signal for the cv
         {
             std::lock_guard lock {m_mutex};
@@ -286,7 +405,7 @@ namespace engine {
         }
         m_cv.notify_one();
 
-        // Wait only for m_should_stop pointer to become available
+        // Wait only for the search instances to become ready
         // If we send then a STOP command, it will be processed and the search will stop at its will
         {
             std::unique_lock lock {m_mutex};
@@ -300,11 +419,22 @@ namespace engine {
     void Engine::stop() {
         ignore_invalid_command_on_init();
 
-        if (m_should_stop != nullptr) {
-            *m_should_stop = true;
+        m_should_stop = true;
+
+        // On a ponder miss, wait for the search to be discarded, so that the GUI can send the actual move next
+        if (m_ponder) {
+            std::unique_lock lock {m_mutex};
+            m_cv.wait(lock, [this]() { return !m_search; });
         }
     }
 
+    void Engine::ponderhit() {
+        ignore_invalid_command_on_init();
+
+        // The search goes on with its limits, as if it had started now
+        m_ponder = false;
+    }
+
     void Engine::getparameters() const {
         ignore_invalid_command_on_init();
 
@@ -362,9 +492,7 @@ namespace engine {
         }
 
         // Do what stop would do
-        if (m_should_stop != nullptr) {
-            *m_should_stop = true;
-        }
+        m_should_stop = true;
 
         // Wake up the thread from sleeping, a signal for the cv
         {
@@ -374,6 +502,8 @@ namespace engine {
         m_cv.notify_one();
 
         m_thread.join();
+
+        m_thread_pool.stop();
     }
 
     void Engine::getname() const {
@@ -388,28 +518,132 @@ namespace engine {
         messages::board(m_position);
     }
 
-    game::Move Engine::search_move(std::unique_lock<std::mutex>& lock) noexcept {
+    void Engine::perft(const std::string& depth, bool divide) const {
+        ignore_invalid_command_on_init();
+
+        // Don't compete with the search
+        if (m_search) {
+            throw error::InvalidCommand();
+        }
+
+        const int perft_depth {parse_int(depth)};
+
+        if (perft_depth < 0) {
+            throw error::InvalidCommand();
+        }
+
+        const auto result {perft::perft(m_position, perft_depth, 1, 0)};
+
+        if (divide) {
+            for (const auto& [move, nodes] : result.root_moves) {
+                messages::perft(move, nodes);
+            }
+        }
+
+        messages::perft(result.nodes, result.time, perft::nodes_per_second(result));
+    }
+
+    game::Move Engine::search_move(std::unique_lock<std::mutex>& lock, game::Move& ponder_move) noexcept {
         m_search_sequence++;
+        m_should_stop = false;
+
+        // Every thread of the pool has its own search; this thread is thread 0 and it runs the main search
+        search::Search instance {m_search_sequence, m_parameters, m_transposition_table, m_should_stop, m_ponder};
+
+        std::vector<std::unique_ptr<search::Search>> helpers;
+        std::vector<search::Search*> searches;
+
+        try {
+            searches.push_back(&instance);
+
+            for (int i {1}; i < m_thread_pool.size(); i++) {
+                helpers.push_back(std::make_unique<search::Search>(
+                    m_search_sequence,
+                    m_parameters,
+                    m_transposition_table,
+                    m_should_stop,
+                    m_ponder,
+                    i
+                ));
+                searches.push_back(helpers.back().get());
+            }
+        } catch (const std::bad_alloc&) {
+            // Search with this thread only
+            helpers.clear();
+        }
 
-        search::Search instance {m_search_sequence, m_parameters, m_transposition_table};
+        for (std::size_t i {0}; i < searches.size(); i++) {
+            if (m_evaluation_caches[i].is_allocated()) {
+                searches[i]->enable_evaluation_cache(&m_evaluation_caches[i]);
+            }
+        }
+
+        // Splitting needs a search for every thread
+        const bool ybwc {std::get<2>(m_parameters.at("ybwc")) && !helpers.empty()};
 
-        m_should_stop = instance.get_should_stop();
         m_instance_ready = true;
 
-        // Notify now that the search instance is ready
+        // Notify now that the search instances are ready
         lock.unlock();  // May throw, but it shouldn't
         m_cv.notify_one();
 
+        std::atomic_int helpers_done {0};
+
+        if (ybwc) {
+            // Young Brothers Wait; the main search splits its nodes between the threads of the pool
+            for (search::Search* search : searches) {
+                search->enable_split(&m_thread_pool, searches.data());
+            }
+        } else {
+            // Lazy SMP; the helpers share only the TT and the stop flag with the main search
+            for (const auto& helper : helpers) {
+                search::Search* search {helper.get()};
+
+                m_thread_pool.push(0, {
+                    [this, search, &helpers_done](int) {
+                        search->search(
+                            m_position,
+                            m_previous_positions,
+                            m_moves_played,
+                            m_search_options.max_depth,
+                            m_search_options.limits
+                        );
+
+                        helpers_done++;
+                    },
+                    &helpers
+                });
+            }
+        }
+
+        // The result of the search is given only by the main search
         const game::Move best_move {instance.search(
             m_position,
             m_previous_positions,
             m_moves_played,
             m_search_options.max_depth,
-            m_search_options.max_time
+            m_search_options.limits
         )};
 
-        // Must reset this back to null here after the search, because it will soon be invalidated
-        m_should_stop = nullptr;
+        // While pondering, the result is needed only after PONDERHIT, and not at all after STOP
+        // An infinite search returns its result only after STOP, even if it finished earlier
+        while ((m_ponder || m_search_options.infinite) && !m_should_stop) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        ponder_move = instance.ponder_move();
+
+        // Lazy helpers don't stop on their own
+        m_should_stop = true;
+
+        if (!ybwc) {
+            // Helpers not yet taken by any worker return right away
+            while (m_thread_pool.run_own(0, &helpers)) {}
+
+            while (helpers_done < static_cast<int>(helpers.size())) {
+                std::this_thread::yield();
+            }
+        }
 
         return best_move;
     }
@@ -443,12 +677,88 @@ namespace engine {
     }
 
     void Engine::initialize_parameters() {
-        m_parameters["material_pawn"] = 25;
-        m_parameters["material_king"] = 56;
-        m_parameters["positioning_pawn"] = 2;
-        m_parameters["positioning_king"] = 4;
-        m_parameters["crowdness"] = 1;
+        m_parameters["material_pawn"] = frozen_parameters::Default::material_pawn;
+        m_parameters["material_king"] = frozen_parameters::Default::material_king;
+        m_parameters["positioning_pawn"] = frozen_parameters::Default::positioning_pawn;
+        m_parameters["positioning_king"] = frozen_parameters::Default::positioning_king;
+        m_parameters["crowdness"] = frozen_parameters::Default::crowdness;
         m_parameters["use_book"] = true;
+        m_parameters["hash_size"] = 0;
+        m_parameters["hash_ratio"] = 0.5f;
+        m_parameters["threads"] = 1;
+        m_parameters["ybwc"] = false;
+        m_parameters["pvs"] = true;
+        m_parameters["lmr"] = true;
+        m_parameters["lmr_depth"] = 3;
+        m_parameters["lmr_moves"] = 3;
+        m_parameters["lmr_base"] = 0.5f;
+        m_parameters["lmr_div"] = 2.5f;
+        m_parameters["multipv"] = 1;
+        m_parameters["eval_cache"] = 0;
+    }
+
+    void Engine::resize_transposition_table() {
+        const int hash_size {std::get<0>(m_parameters.at("hash_size"))};
+        const float hash_ratio {std::get<1>(m_parameters.at("hash_ratio"))};
+
+        if (hash_size == m_hash_size && hash_ratio == m_hash_ratio) {
+            return;
+        }
+
+        // Free the old table first, so that its memory counts as available
+        m_transposition_table.deallocate();
+
+        try {
+            m_transposition_table.allocate(transposition_table_size(hash_size, hash_ratio));
+        } catch (const std::bad_alloc&) {
+            throw error::Fatal();
+        }
+
+        m_hash_size = hash_size;
+        m_hash_ratio = hash_ratio;
+    }
+
+    void Engine::setup_thread_pool() {
+        const int threads {std::clamp(std::get<0>(m_parameters.at("threads")), 1, MAX_THREADS)};
+
+        if (threads == m_thread_pool.size()) {
+            return;
+        }
+
+        try {
+            m_thread_pool.start(threads);
+        } catch (const std::system_error&) {
+            throw error::Fatal();
+        }
+    }
+
+    void Engine::setup_evaluation_caches() {
+        const int eval_cache_size {std::max(std::get<0>(m_parameters.at("eval_cache")), 0)};
+
+        // The parameters of the evaluation may have changed since the last search
+        if (eval_cache_size == m_eval_cache_size && static_cast<int>(m_evaluation_caches.size()) == m_thread_pool.size()) {
+            for (evaluation_cache::EvaluationCache& evaluation_cache : m_evaluation_caches) {
+                evaluation_cache.clear();
+            }
+
+            return;
+        }
+
+        // Free the old caches first
+        m_evaluation_caches.clear();
+
+        try {
+            // Size in KiB, for every thread
+            m_evaluation_caches.resize(static_cast<std::size_t>(m_thread_pool.size()));
+
+            for (evaluation_cache::EvaluationCache& evaluation_cache : m_evaluation_caches) {
+                evaluation_cache.allocate(static_cast<std::size_t>(eval_cache_size) * 1024);
+            }
+        } catch (const std::bad_alloc&) {
+            throw error::Fatal();
+        }
+
+        m_eval_cache_size = eval_cache_size;
     }
 
     void Engine::ignore_invalid_command_on_init(bool after_init) const {
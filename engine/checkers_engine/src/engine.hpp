@@ -6,13 +6,32 @@
 #include <mutex>
 #include <string>
 #include <optional>
+#include <atomic>
 
 #include "game.hpp"
 #include "parameters.hpp"
 #include "transposition_table.hpp"
+#include "evaluation_cache.hpp"
 #include "book.hpp"
+#include "thread_pool.hpp"
+#include "time_manager.hpp"
 
 namespace engine {
+    // The arguments of GO, as received; every one of them is optional
+    struct GoArguments {
+        std::optional<std::string> max_depth;
+        std::optional<std::string> max_time;
+        std::optional<std::string> black_time;
+        std::optional<std::string> white_time;
+        std::optional<std::string> black_increment;
+        std::optional<std::string> white_increment;
+        std::optional<std::string> moves_to_go;
+        std::optional<std::string> nodes;
+        bool dont_play_move {false};
+        bool ponder {false};
+        bool infinite {false};
+    };
+
     class Engine {
     public:
         // Commands the engine executes
@@ -20,19 +39,24 @@ namespace engine {
         void init();
         void newgame(const std::optional<std::string>& position, const std::optional<std::vector<std::string>>& moves);
         void move(const std::string& move);
-        void go(const std::optional<std::string>& max_depth, const std::optional<std::string>& max_time, bool dont_play_move);
+        void go(const GoArguments& arguments);
         void stop();
+        void ponderhit();
         void getparameters() const;
         void getparameter(const std::string& name) const;
         void setparameter(const std::string& name, const std::string& value);
         void quit();
         void getname() const;
         void board() const;
+        void perft(const std::string& depth, bool divide) const;
     private:
-        game::Move search_move(std::unique_lock<std::mutex>& lock) noexcept;
+        game::Move search_move(std::unique_lock<std::mutex>& lock, game::Move& ponder_move) noexcept;
         bool lookup_book();
         void reset_position(const std::string& position_string);
         void initialize_parameters();
+        void resize_transposition_table();
+        void setup_thread_pool();
+        void setup_evaluation_caches();
         void ignore_invalid_command_on_init(bool after_init = false) const;
 
         std::thread m_thread;
@@ -40,17 +64,28 @@ namespace engine {
         std::mutex m_mutex;
         parameters::Parameters m_parameters;
         transposition_table::TranspositionTable m_transposition_table;
+        thread_pool::ThreadPool m_thread_pool;
         book::Book m_opening_book;
 
+        // One for every thread of the pool
+        std::vector<evaluation_cache::EvaluationCache> m_evaluation_caches;
+
         // Thread flag; set to true on initialization
         bool m_running {false};
 
         // Thread flag; set to true when there is something to search or when the engine needs to stop
         bool m_search {false};
 
-        // Thread flag; set to true when m_should_stop is set
+        // Thread flag; set to true when the search instances are created
         bool m_instance_ready {false};
 
+        // Parameters with which the TT was allocated; it's reallocated only when they change
+        int m_hash_size {-1};
+        float m_hash_ratio {};
+
+        // Size with which the evaluation caches were allocated
+        int m_eval_cache_size {-1};
+
         // Number representing a particular search
         int m_search_sequence {0};
 
@@ -63,14 +98,21 @@ namespace engine {
         // move0, move1, move2, ..., moveN (most recent)
         std::vector<game::Move> m_moves_played;
 
-        // Setup at every instance invocation
-        bool* m_should_stop {nullptr};
+        // Stops the main search and all of its helpers; reset before every search
+        std::atomic_bool m_should_stop {false};
+
+        // Set while searching on the opponent's time, until PONDERHIT or STOP
+        std::atomic_bool m_ponder {false};
+
+        // The expected reply of the opponent, from the PV of the last search
+        game::Move m_ponder_move {game::NULL_MOVE};
 
         // Variables used by the search, must be reset every time before the search
         struct SearchOptions {
             bool dont_play_move {};
+            bool infinite {};
             int max_depth {};
-            double max_time {};
+            time_manager::Limits limits;
         } m_search_options;
     };
 }
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <limits>
+#include <cassert>
 
 #include "game.hpp"
 #include "parameters.hpp"
+#include "evaluation_terms.hpp"
 
 namespace evaluation {
     using Eval = int;
@@ -24,5 +26,21 @@ namespace evaluation {
         return position.player == game::Player::Black ? -1 : 1;
     }
 
-    Eval static_evaluation(const game::SearchNode& node, const parameters::SearchParameters& parameters) noexcept;
+    Eval static_evaluation(const game::GamePosition& position, const parameters::SearchParameters& parameters) noexcept;
+
+    // The weights are constants of a frozen parameter set, so that the multiplications are folded
+    template<typename Parameters>
+    Eval static_evaluation(const game::GamePosition& position) noexcept {
+        assert(position.terms == evaluation_terms::compute(position));
+
+        Eval eval {0};
+
+        eval += position.terms.pawns * Parameters::material_pawn;
+        eval += position.terms.kings * Parameters::material_king;
+        eval += position.terms.positioning_pawn * Parameters::positioning_pawn;
+        eval += position.terms.positioning_king * Parameters::positioning_king;
+        eval += position.terms.crowdness * Parameters::crowdness;
+
+        return eval;
+    }
 }
@@ -0,0 +1,27 @@
+#include "evaluation_cache.hpp"
+
+#include <algorithm>
+
+namespace evaluation_cache {
+    void EvaluationCache::allocate(std::size_t size_bytes) {
+        m_entries.reset();
+        m_size = 0;
+
+        if (size_bytes < sizeof(Entry)) {
+            return;
+        }
+
+        std::size_t size {1};
+
+        while (size * 2 <= size_bytes / sizeof(Entry)) {
+            size *= 2;
+        }
+
+        m_entries = std::make_unique<Entry[]>(size);
+        m_size = size;
+    }
+
+    void EvaluationCache::clear() noexcept {
+        std::fill(m_entries.get(), m_entries.get() + m_size, Entry());
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+#include "game.hpp"
+#include "evaluation.hpp"
+
+// https://www.chessprogramming.org/Evaluation_Hash_Table
+
+namespace evaluation_cache {
+    // Static evaluations of leaf positions; every thread has its own, so it needs no synchronization
+    // Lossy; every key has a single entry, which is always replaced
+    class EvaluationCache {
+    public:
+        // The number of entries is rounded down to a power of two; no bytes means no cache
+        void allocate(std::size_t size_bytes);
+
+        void clear() noexcept;
+
+        bool is_allocated() const noexcept {
+            return m_size > 0;
+        }
+
+        bool load(game::PositionKey key, evaluation::Eval& eval) const noexcept {
+            const Entry& entry {m_entries[index(key)]};
+
+            if (entry.tag != tag(key)) {
+                return false;
+            }
+
+            eval = entry.eval;
+
+            return true;
+        }
+
+        void store(game::PositionKey key, evaluation::Eval eval) noexcept {
+            m_entries[index(key)] = {tag(key), eval};
+        }
+    private:
+        struct Entry {
+            std::uint32_t tag {0};  // Zero means empty
+            evaluation::Eval eval {};
+        };
+
+        std::size_t index(game::PositionKey key) const noexcept {
+            return static_cast<std::size_t>(key) & (m_size - 1);
+        }
+
+        // The upper half of the key, which is not used for the index; never zero
+        static std::uint32_t tag(game::PositionKey key) noexcept {
+            return static_cast<std::uint32_t>(key >> 32) | 1u;
+        }
+
+        std::unique_ptr<Entry[]> m_entries;
+        std::size_t m_size {0};
+    };
+}
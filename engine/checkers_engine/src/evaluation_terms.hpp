@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+
+#include "game.hpp"
+#include "bitboard.hpp"
+#include "tables.hpp"
+
+// The terms of the static evaluation, kept up to date by the moves, so that the evaluation doesn't scan the board
+
+namespace evaluation_terms {
+    template<int M>
+    constexpr auto positioning_king() noexcept {
+        return std::array<int, 32> {
+            M, M, M, M,
+            M, 0, 0, 0,
+            0, 1, 1, M,
+            M, 1, 1, 0,
+            0, 1, 1, M,
+            M, 1, 1, 0,
+            0, 0, 0, M,
+            M, M, M, M
+        };
+    }
+
+    // Pawn pieces are encouraged to advance the rank while generally avoiding the sides (less freedom)
+    // King pieces are encouraged to control the center (this helps the endgame)
+
+    inline constexpr int POSITIONING_PAWN_BLACK[] {
+        8, 0, 8, 0,
+        0, 1, 2, 1,
+        2, 3, 2, 1,
+        2, 3, 4, 3,
+        4, 5, 4, 3,
+        4, 5, 6, 5,
+        6, 7, 6, 5,
+        0, 0, 0, 0
+    };
+
+    inline constexpr int POSITIONING_PAWN_WHITE[] {
+        0, 0, 0, 0,
+        5, 6, 7, 6,
+        5, 6, 5, 4,
+        3, 4, 5, 4,
+        3, 4, 3, 2,
+        1, 2, 3, 2,
+        1, 2, 1, 0,
+        0, 8, 0, 8
+    };
+
+    inline constexpr auto POSITIONING_KING {positioning_king<-2>()};
+
+    // Pieces with neighbors of the same color get bonus points, but being surrounded is worth less
+    constexpr int crowdness(int neighbors) noexcept {
+        return neighbors == 4 ? 2 : neighbors;
+    }
+
+    // What the piece on the square adds to the terms, including what it adds to its neighbors' crowdness
+    inline game::EvaluationTerms piece_terms(const game::Position& position, int index) noexcept {
+        const game::Square square {position.board[index]};
+        const game::Player player {game::is_black_piece(square) ? game::Player::Black : game::Player::White};
+        const int sign {player == game::Player::Black ? -1 : 1};
+
+        game::EvaluationTerms terms;
+
+        switch (square) {
+            case game::Square::None:
+                break;
+            case game::Square::Black:
+                terms.pawns = -1;
+                terms.positioning_pawn = -POSITIONING_PAWN_BLACK[index];
+                break;
+            case game::Square::BlackKing:
+                terms.kings = -1;
+                terms.positioning_king = -POSITIONING_KING[index];
+                break;
+            case game::Square::White:
+                terms.pawns = 1;
+                terms.positioning_pawn = POSITIONING_PAWN_WHITE[index];
+                break;
+            case game::Square::WhiteKing:
+                terms.kings = 1;
+                terms.positioning_king = POSITIONING_KING[index];
+                break;
+        }
+
+        // The bitboards are in sync with the board
+        const bitboard::Bitboard pieces {game::pieces(position, player)};
+        bitboard::Bitboard neighbors {tables::NEIGHBORS[index] & pieces};
+
+        int crowdness_delta {crowdness(bitboard::pop_count(neighbors))};
+
+        while (neighbors != bitboard::EMPTY) {
+            const int neighbor_count {bitboard::pop_count(tables::NEIGHBORS[bitboard::pop_index(neighbors)] & pieces)};
+            crowdness_delta += crowdness(neighbor_count) - crowdness(neighbor_count - 1);
+        }
+
+        terms.crowdness = sign * crowdness_delta;
+
+        return terms;
+    }
+
+    // Call it right after placing a piece, with the bitboards updated
+    inline void add(game::GamePosition& position, int index) noexcept {
+        const game::EvaluationTerms terms {piece_terms(position, index)};
+
+        position.terms.pawns += terms.pawns;
+        position.terms.kings += terms.kings;
+        position.terms.positioning_pawn += terms.positioning_pawn;
+        position.terms.positioning_king += terms.positioning_king;
+        position.terms.crowdness += terms.crowdness;
+    }
+
+    // Call it right before removing a piece, with the bitboards not yet updated
+    inline void remove(game::GamePosition& position, int index) noexcept {
+        const game::EvaluationTerms terms {piece_terms(position, index)};
+
+        position.terms.pawns -= terms.pawns;
+        position.terms.kings -= terms.kings;
+        position.terms.positioning_pawn -= terms.positioning_pawn;
+        position.terms.positioning_king -= terms.positioning_king;
+        position.terms.crowdness -= terms.crowdness;
+    }
+
+    inline int sum_table(const int* table, bitboard::Bitboard pieces) noexcept {
+        int sum {0};
+
+        while (pieces != bitboard::EMPTY) {
+            sum += table[bitboard::pop_index(pieces)];
+        }
+
+        return sum;
+    }
+
+    // The crowdness of all pieces of one color at once
+    inline int sum_crowdness(bitboard::Bitboard pieces) noexcept {
+        // Pieces having a neighbor in that direction
+        const bitboard::Bitboard north_east {bitboard::shift<bitboard::Direction::SouthWest>(pieces) & pieces};
+        const bitboard::Bitboard north_west {bitboard::shift<bitboard::Direction::SouthEast>(pieces) & pieces};
+        const bitboard::Bitboard south_east {bitboard::shift<bitboard::Direction::NorthWest>(pieces) & pieces};
+        const bitboard::Bitboard south_west {bitboard::shift<bitboard::Direction::NorthEast>(pieces) & pieces};
+
+        const int neighbors {
+            bitboard::pop_count(north_east) +
+            bitboard::pop_count(north_west) +
+            bitboard::pop_count(south_east) +
+            bitboard::pop_count(south_west)
+        };
+
+        // Surrounded pieces count 2 instead of 4
+        const bitboard::Bitboard surrounded {north_east & north_west & south_east & south_west};
+
+        return neighbors - 2 * bitboard::pop_count(surrounded);
+    }
+
+    // Compute the terms from scratch, from the bitboards
+    inline game::EvaluationTerms compute(const game::Position& position) noexcept {
+        const bitboard::Bitboard black_pawns {position.black & ~position.kings};
+        const bitboard::Bitboard black_kings {position.black & position.kings};
+        const bitboard::Bitboard white_pawns {position.white & ~position.kings};
+        const bitboard::Bitboard white_kings {position.white & position.kings};
+
+        game::EvaluationTerms terms;
+
+        terms.pawns = bitboard::pop_count(white_pawns) - bitboard::pop_count(black_pawns);
+        terms.kings = bitboard::pop_count(white_kings) - bitboard::pop_count(black_kings);
+        terms.positioning_pawn = sum_table(POSITIONING_PAWN_WHITE, white_pawns) - sum_table(POSITIONING_PAWN_BLACK, black_pawns);
+        terms.positioning_king = sum_table(POSITIONING_KING.data(), white_kings) - sum_table(POSITIONING_KING.data(), black_kings);
+        terms.crowdness = sum_crowdness(position.white) - sum_crowdness(position.black);
+
+        return terms;
+    }
+}
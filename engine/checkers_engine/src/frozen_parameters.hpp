@@ -0,0 +1,17 @@
+#pragma once
+
+#include "parameters.hpp"
+
+// Sets of evaluation parameters baked in at compile time; build with FROZEN_EVALUATION set to the name of one
+// The evaluation parameters of the engine then have no effect
+
+namespace frozen_parameters {
+    // The defaults of the engine, which initializes its parameters from these
+    struct Default {
+        static constexpr parameters::Int material_pawn {25};
+        static constexpr parameters::Int material_king {56};
+        static constexpr parameters::Int positioning_pawn {2};
+        static constexpr parameters::Int positioning_king {4};
+        static constexpr parameters::Int crowdness {1};
+    };
+}
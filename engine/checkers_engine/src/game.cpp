@@ -11,6 +11,7 @@
 #include "error.hpp"
 #include "utils.hpp"
 #include "zobrist.hpp"
+#include "evaluation_terms.hpp"
 
 namespace game {
     static std::vector<std::string> split(const std::string& string, const char* delimiter) {
@@ -173,6 +174,50 @@ namespace game {
         }
     }
 
+    static void set_bitboards(Position& position) noexcept {
+        position.black = 0;
+        position.white = 0;
+        position.kings = 0;
+
+        for (int i {0}; i < 32; i++) {
+            if (is_black_piece(position.board[i])) {
+                position.black |= bitboard::bit(i);
+            }
+
+            if (is_white_piece(position.board[i])) {
+                position.white |= bitboard::bit(i);
+            }
+
+            if (is_king_piece(position.board[i])) {
+                position.kings |= bitboard::bit(i);
+            }
+        }
+    }
+
+    static void move_piece_bitboards(Position& position, int source_index, int destination_index) noexcept {
+        // Source and destination may be the same, in which case nothing changes
+        const bitboard::Bitboard mask {bitboard::bit(source_index) ^ bitboard::bit(destination_index)};
+
+        if (position.black & bitboard::bit(source_index)) {
+            position.black ^= mask;
+        } else {
+            position.white ^= mask;
+        }
+
+        if (position.kings & bitboard::bit(source_index)) {
+            position.kings ^= mask;
+        }
+    }
+
+    static void remove_piece_bitboards(Position& position, int index) noexcept {
+        const bitboard::Bitboard mask {~bitboard::bit(index)};
+
+        position.black &= mask;
+        position.white &= mask;
+        position.kings &= mask;
+    }
+
+    template<bool UpdateTerms>
     static void remove_jumped_pieces(GamePosition& position, Move move) noexcept {
         assert(move.type() == MoveType::Capture);
 
@@ -191,7 +236,11 @@ namespace game {
 
             const auto square {position.board[_1_32_to_0_31(index)]};
 
+            if constexpr (UpdateTerms) {
+                evaluation_terms::remove(position, _1_32_to_0_31(index));
+            }
             position.board[_1_32_to_0_31(index)] = Square::None;
+            remove_piece_bitboards(position, _1_32_to_0_31(index));
             position.key ^= zobrist::instance.hash_mod(square, _1_32_to_0_31(index));
             position.signature &= signature_mod(_1_32_to_0_31(index));
         }
@@ -211,12 +260,17 @@ namespace game {
 
             const auto square {position.board[_1_32_to_0_31(index)]};
 
+            if constexpr (UpdateTerms) {
+                evaluation_terms::remove(position, _1_32_to_0_31(index));
+            }
             position.board[_1_32_to_0_31(index)] = Square::None;
+            remove_piece_bitboards(position, _1_32_to_0_31(index));
             position.key ^= zobrist::instance.hash_mod(square, _1_32_to_0_31(index));
             position.signature &= signature_mod(_1_32_to_0_31(index));
         }
     }
 
+    template<bool UpdateTerms>
     static void check_piece_crowning(GamePosition& position, int square_index) noexcept {
         const int row {square_index / 4};
 
@@ -227,7 +281,14 @@ namespace game {
                         break;
                     }
 
+                    if constexpr (UpdateTerms) {
+                        evaluation_terms::remove(position, square_index);
+                    }
                     position.board[square_index] = Square::BlackKing;
+                    position.kings |= bitboard::bit(square_index);
+                    if constexpr (UpdateTerms) {
+                        evaluation_terms::add(position, square_index);
+                    }
                     position.key ^= zobrist::instance.hash_mod(Square::Black, square_index);
                     position.key ^= zobrist::instance.hash_mod(Square::BlackKing, square_index);
                     position.signature |= signature_mod(Square::BlackKing, square_index);
@@ -239,7 +300,14 @@ namespace game {
                         break;
                     }
 
+                    if constexpr (UpdateTerms) {
+                        evaluation_terms::remove(position, square_index);
+                    }
                     position.board[square_index] = Square::WhiteKing;
+                    position.kings |= bitboard::bit(square_index);
+                    if constexpr (UpdateTerms) {
+                        evaluation_terms::add(position, square_index);
+                    }
                     position.key ^= zobrist::instance.hash_mod(Square::White, square_index);
                     position.key ^= zobrist::instance.hash_mod(Square::WhiteKing, square_index);
                     position.signature |= signature_mod(Square::WhiteKing, square_index);
@@ -248,22 +316,38 @@ namespace game {
         }
     }
 
+    template<bool UpdateTerms>
     static void play_normal_move(GamePosition& position, Move move) noexcept {
         const auto square {position.board[move.source_index()]};
 
+        if constexpr (UpdateTerms) {
+            evaluation_terms::remove(position, move.source_index());
+        }
         std::swap(position.board[move.source_index()], position.board[move.destination_index()]);
+        move_piece_bitboards(position, move.source_index(), move.destination_index());
+        if constexpr (UpdateTerms) {
+            evaluation_terms::add(position, move.destination_index());
+        }
         position.key ^= zobrist::instance.hash_mod(square, move.source_index());
         position.key ^= zobrist::instance.hash_mod(square, move.destination_index());
         position.signature &= signature_mod(move.source_index());
         position.signature |= signature_mod(square, move.destination_index());
     }
 
+    template<bool UpdateTerms>
     static void play_capture_move(GamePosition& position, Move move) noexcept {
-        remove_jumped_pieces(position, move);
+        remove_jumped_pieces<UpdateTerms>(position, move);
 
         const auto square {position.board[move.source_index()]};
 
+        if constexpr (UpdateTerms) {
+            evaluation_terms::remove(position, move.source_index());
+        }
         std::swap(position.board[move.source_index()], position.board[move.destination_index(move.destination_indices_size() - 1)]);
+        move_piece_bitboards(position, move.source_index(), move.destination_index(move.destination_indices_size() - 1));
+        if constexpr (UpdateTerms) {
+            evaluation_terms::add(position, move.destination_index(move.destination_indices_size() - 1));
+        }
         position.key ^= zobrist::instance.hash_mod(square, move.source_index());
         position.key ^= zobrist::instance.hash_mod(square, move.destination_index(move.destination_indices_size() - 1));
         position.signature &= signature_mod(move.source_index());
@@ -385,10 +469,12 @@ namespace game {
         const auto [board, player] {parse_position_string(position_string)};
 
         position.board = board;
+        set_bitboards(position);
         position.player = player;
         position.plies_without_advancement = 0;
         position.key = zobrist::instance.hash(position);
         position.signature = signature(position);
+        position.terms = evaluation_terms::compute(position);
     }
 
     void play_move(GamePosition& position, const std::string& move_string) {
@@ -401,13 +487,15 @@ namespace game {
         play_move(position, move);
     }
 
-    void play_move(GamePosition& position, Move move) noexcept {
+    // Perft never evaluates, so it may skip updating the evaluation terms
+    template<bool UpdateTerms>
+    static void play_move(GamePosition& position, Move move) noexcept {
         switch (move.type()) {
             case MoveType::Normal:
                 assert(position.board[move.source_index()] != Square::None);
                 assert(position.board[move.destination_index()] == Square::None);
 
-                play_normal_move(position, move);
+                play_normal_move<UpdateTerms>(position, move);
 
                 if (!is_king_piece(position.board[move.destination_index()])) {
                     position.plies_without_advancement = 0;
@@ -415,7 +503,7 @@ namespace game {
                     position.plies_without_advancement++;
                 }
 
-                check_piece_crowning(position, move.destination_index());
+                check_piece_crowning<UpdateTerms>(position, move.destination_index());
 
                 break;
             case MoveType::Capture:
@@ -425,11 +513,11 @@ namespace game {
                     move.source_index() == move.destination_index(move.destination_indices_size() - 1)
                 );
 
-                play_capture_move(position, move);
+                play_capture_move<UpdateTerms>(position, move);
 
                 position.plies_without_advancement = 0;
 
-                check_piece_crowning(position, move.destination_index(move.destination_indices_size() - 1));
+                check_piece_crowning<UpdateTerms>(position, move.destination_index(move.destination_indices_size() - 1));
 
                 break;
         }
@@ -439,43 +527,73 @@ namespace game {
         position.signature ^= signature_mod();
     }
 
-    void play_move(SearchNode& node, Move move) noexcept {
-        switch (move.type()) {
-            case MoveType::Normal:
-                assert(node.board[move.source_index()] != Square::None);
-                assert(node.board[move.destination_index()] == Square::None);
+    void play_move(GamePosition& position, Move move) noexcept {
+        play_move<true>(position, move);
+    }
 
-                play_normal_move(node, move);
+    void play_move_bare(GamePosition& position, Move move) noexcept {
+        play_move<false>(position, move);
+    }
 
-                if (!is_king_piece(node.board[move.destination_index()])) {
-                    node.plies_without_advancement = 0;
-                    node.previous = nullptr;
-                } else {
-                    node.plies_without_advancement++;
-                }
+    void make_move(GamePosition& position, Move move, MoveUndo& undo) noexcept {
+        const bitboard::Bitboard enemy {pieces(position, opponent(position.player))};
+        const bitboard::Bitboard kings {position.kings};
+        const int destination_index {move.destination_index(move.destination_indices_size() - 1)};
 
-                check_piece_crowning(node, move.destination_index());
+        undo.plies_without_advancement = position.plies_without_advancement;
+        undo.key = position.key;
+        undo.signature = position.signature;
+        undo.terms = position.terms;
 
-                break;
-            case MoveType::Capture:
-                assert(node.board[move.source_index()] != Square::None);
-                assert(
-                    node.board[move.destination_index(move.destination_indices_size() - 1)] == Square::None ||
-                    move.source_index() == move.destination_index(move.destination_indices_size() - 1)
-                );
+        play_move(position, move);
 
-                play_capture_move(node, move);
+        // The player has already changed
+        undo.captured = enemy & ~pieces(position, position.player);
+        undo.captured_kings = undo.captured & kings;
+        undo.crowned = !(kings & bitboard::bit(move.source_index())) && (position.kings & bitboard::bit(destination_index));
+    }
 
-                node.plies_without_advancement = 0;
-                node.previous = nullptr;
+    void unmake_move(GamePosition& position, Move move, const MoveUndo& undo) noexcept {
+        const Player player {opponent(position.player)};  // The player who made the move
+        const int source_index {move.source_index()};
+        const int destination_index {move.destination_index(move.destination_indices_size() - 1)};
 
-                check_piece_crowning(node, move.destination_index(move.destination_indices_size() - 1));
+        auto square {position.board[destination_index]};
 
-                break;
+        if (undo.crowned) {
+            square = static_cast<Square>(static_cast<std::underlying_type_t<Square>>(square) & 0b011u);
+            position.kings &= ~bitboard::bit(destination_index);
+        }
+
+        position.board[destination_index] = Square::None;
+        position.board[source_index] = square;
+        move_piece_bitboards(position, destination_index, source_index);
+
+        // Put back the captured pieces
+        bitboard::Bitboard captured {undo.captured};
+
+        while (captured != bitboard::EMPTY) {
+            const int index {bitboard::pop_index(captured)};
+
+            if (player == Player::Black) {
+                position.board[index] = undo.captured_kings & bitboard::bit(index) ? Square::WhiteKing : Square::White;
+            } else {
+                position.board[index] = undo.captured_kings & bitboard::bit(index) ? Square::BlackKing : Square::Black;
+            }
         }
 
-        node.player = opponent(node.player);
-        node.key ^= zobrist::instance.hash_mod();
-        node.signature ^= signature_mod();
+        if (player == Player::Black) {
+            position.white |= undo.captured;
+        } else {
+            position.black |= undo.captured;
+        }
+
+        position.kings |= undo.captured_kings;
+
+        position.player = player;
+        position.plies_without_advancement = undo.plies_without_advancement;
+        position.key = undo.key;
+        position.signature = undo.signature;
+        position.terms = undo.terms;
     }
 }
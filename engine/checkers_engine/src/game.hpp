@@ -6,6 +6,7 @@
 #include <cstdint>
 
 #include "uint128t.hpp"
+#include "bitboard.hpp"
 
 namespace game {
     inline constexpr int NULL_INDEX {-1};  // Indices may be in the range [0, 31] or [1, 32]
@@ -28,6 +29,12 @@ namespace game {
 
     struct Position {
         Board board {};
+
+        // The same pieces as on the board, kept in sync with it
+        bitboard::Bitboard black {0};
+        bitboard::Bitboard white {0};
+        bitboard::Bitboard kings {0};
+
         Player player {Player::Black};  // Next player to move
     };
 
@@ -39,14 +46,41 @@ namespace game {
     using PositionSignature = __uint128_t;  // Truly unique position number
 #endif
 
+    // The parameter independent terms of the static evaluation, as white's minus black's
+    struct EvaluationTerms {
+        int pawns {0};
+        int kings {0};
+        int positioning_pawn {0};
+        int positioning_king {0};
+        int crowdness {0};
+
+        bool operator==(const EvaluationTerms& other) const noexcept {
+            return (
+                pawns == other.pawns &&
+                kings == other.kings &&
+                positioning_pawn == other.positioning_pawn &&
+                positioning_king == other.positioning_king &&
+                crowdness == other.crowdness
+            );
+        }
+    };
+
     struct GamePosition : Position {
         int plies_without_advancement {0};
         PositionKey key {0};
         PositionSignature signature {0};
+        EvaluationTerms terms;  // Updated incrementally, like the key and the signature
     };
 
-    struct SearchNode : GamePosition {
-        const SearchNode* previous {nullptr};
+    // Everything needed to take back a move
+    struct MoveUndo {
+        bitboard::Bitboard captured {0};  // Squares of the captured pieces
+        bitboard::Bitboard captured_kings {0};
+        bool crowned {false};
+        int plies_without_advancement {0};
+        PositionKey key {0};
+        PositionSignature signature {0};
+        EvaluationTerms terms;
     };
 
     enum class MoveType : int {
@@ -110,42 +144,18 @@ namespace game {
     inline constexpr Move NULL_MOVE {};
     inline constexpr int MAX_DEPTH {64};
 
+    // Captures extend the search beyond the max depth, but there can't be more than 24 of them
+    inline constexpr int MAX_PLY {MAX_DEPTH + 24};
+
     struct PvLine {
-        Move moves[MAX_DEPTH];
+        Move moves[MAX_PLY];
         int size {};
     };
 
-    constexpr void fill_node(SearchNode& current, const SearchNode& previous) noexcept {
-        current.board = previous.board;
-        current.player = previous.player;
-        current.plies_without_advancement = previous.plies_without_advancement;
-        current.key = previous.key;
-        current.signature = previous.signature;
-        current.previous = &previous;
-    }
-
     constexpr bool is_forty_move_rule(const GamePosition& position) noexcept {
         return position.plies_without_advancement == 80;
     }
 
-    constexpr bool is_threefold_repetition_rule(const SearchNode& node) noexcept {
-        const SearchNode* prev_node {node.previous};
-
-        int repetitions {1};
-
-        while (prev_node != nullptr) {
-            if (prev_node->signature == node.signature) {
-                if (++repetitions == 3) {
-                    return true;
-                }
-            }
-
-            prev_node = prev_node->previous;
-        }
-
-        return false;
-    }
-
     constexpr bool is_move_capture(Move move) noexcept {
         return move.type() == MoveType::Capture;
     }
@@ -192,6 +202,14 @@ namespace game {
         }
     }
 
+    constexpr bitboard::Bitboard pieces(const Position& position, Player player) noexcept {
+        if (player == Player::Black) {
+            return position.black;
+        } else {
+            return position.white;
+        }
+    }
+
     constexpr PositionSignature signature(const Position& position) noexcept {
         PositionSignature result {0};
 
@@ -222,5 +240,10 @@ namespace game {
     void set_position(GamePosition& position, const std::string& position_string);
     void play_move(GamePosition& position, const std::string& move_string);
     void play_move(GamePosition& position, Move move) noexcept;
-    void play_move(SearchNode& node, Move move) noexcept;
+
+    // Like play_move, but leaves the evaluation terms out of date; for perft, which never evaluates
+    void play_move_bare(GamePosition& position, Move move) noexcept;
+
+    void make_move(GamePosition& position, Move move, MoveUndo& undo) noexcept;
+    void unmake_move(GamePosition& position, Move move, const MoveUndo& undo) noexcept;
 }
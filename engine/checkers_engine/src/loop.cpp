@@ -42,6 +42,8 @@ namespace loop {
             commands::go(engine, input_tokens);
         } else if (command_name == "STOP") {
             commands::stop(engine, input_tokens);
+        } else if (command_name == "PONDERHIT") {
+            commands::ponderhit(engine, input_tokens);
         } else if (command_name == "GETPARAMETERS") {
             commands::getparameters(engine, input_tokens);
         } else if (command_name == "GETPARAMETER") {
@@ -52,6 +54,8 @@ namespace loop {
             commands::getname(engine, input_tokens);
         } else if (command_name == "BOARD") {
             commands::board(engine, input_tokens);
+        } else if (command_name == "PERFT") {
+            commands::perft(engine, input_tokens);
         } else {
             throw error::InvalidCommand();
         }
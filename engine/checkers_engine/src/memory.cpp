@@ -0,0 +1,88 @@
+#include "memory.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+
+// https://docs.kernel.org/admin-guide/cgroup-v2.html#memory-interface-files
+// https://www.kernel.org/doc/Documentation/cgroup-v1/memory.txt
+// https://man7.org/linux/man-pages/man5/proc_meminfo.5.html
+
+namespace memory {
+    static std::optional<std::size_t> read_cgroup_limit() {
+        // cgroup v2; the value is "max" when there is no limit
+        {
+            std::ifstream stream {"/sys/fs/cgroup/memory.max"};
+            std::string value;
+
+            if (stream >> value) {
+                if (value == "max") {
+                    return std::nullopt;
+                }
+
+                try {
+                    return static_cast<std::size_t>(std::stoull(value));
+                } catch (...) {  // stoull
+                    return std::nullopt;
+                }
+            }
+        }
+
+        // cgroup v1; the value is a huge number when there is no limit, which is fine
+        {
+            std::ifstream stream {"/sys/fs/cgroup/memory/memory.limit_in_bytes"};
+            unsigned long long value {};
+
+            if (stream >> value) {
+                return static_cast<std::size_t>(value);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    static std::optional<std::size_t> read_meminfo() {
+        std::ifstream stream {"/proc/meminfo"};
+        std::string line;
+
+        std::optional<std::size_t> total;
+
+        // Lines are like "MemTotal:       16287436 kB"; some have no unit
+        while (std::getline(stream, line)) {
+            std::istringstream line_stream {line};
+            std::string name;
+            unsigned long long value {};
+
+            if (!(line_stream >> name >> value)) {
+                continue;
+            }
+
+            // Prefer the available memory over the total memory
+            if (name == "MemAvailable:") {
+                return static_cast<std::size_t>(value) * 1024;
+            }
+
+            if (name == "MemTotal:") {
+                total = static_cast<std::size_t>(value) * 1024;
+            }
+        }
+
+        return total;
+    }
+
+    std::optional<std::size_t> available_memory() {
+        const auto cgroup_limit {read_cgroup_limit()};
+        const auto meminfo {read_meminfo()};
+
+        if (cgroup_limit && meminfo) {
+            return std::min(*cgroup_limit, *meminfo);
+        }
+
+        if (cgroup_limit) {
+            return cgroup_limit;
+        }
+
+        return meminfo;
+    }
+}
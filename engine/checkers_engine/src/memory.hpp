@@ -0,0 +1,10 @@
+#pragma once
+
+#include <optional>
+#include <cstddef>
+
+namespace memory {
+    // Memory in bytes available to the process, taking into account the cgroup limit
+    // Only Linux is supported; return nothing, if it can't be determined
+    std::optional<std::size_t> available_memory();
+}
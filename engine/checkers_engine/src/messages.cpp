@@ -40,7 +40,7 @@ namespace messages {
         std::cout << "READY" << std::endl;
     }
 
-    void bestmove(game::Move move) {
+    void bestmove(game::Move move, game::Move ponder_move) {
         std::lock_guard lock {g_mutex};
 
         std::cout << "BESTMOVE ";
@@ -51,6 +51,10 @@ namespace messages {
             std::cout << "none";
         }
 
+        if (ponder_move != game::NULL_MOVE) {
+            std::cout << " ponder " << game::move_to_string(ponder_move);
+        }
+
         std::cout << std::endl;
     }
 
@@ -94,8 +98,12 @@ namespace messages {
 
     void info(
         int nodes,
+        int quiescence_nodes,
         int transpositions,
+        int hashfull,
+        int cache_hits,
         int depth,
+        int multipv,
         evaluation::Eval eval,
         double time,
         const game::Move* pv_moves,
@@ -105,8 +113,20 @@ namespace messages {
 
         std::cout << "INFO ";
         std::cout << "nodes " << nodes << ' ';
+        std::cout << "qnodes " << quiescence_nodes << ' ';
         std::cout << "transpositions " << transpositions << ' ';
+        std::cout << "hashfull " << hashfull << ' ';
+
+        if (cache_hits >= 0) {
+            std::cout << "cachehits " << cache_hits << ' ';
+        }
         std::cout << "depth " << depth << ' ';
+
+        // Only multi-PV searches tag their lines
+        if (multipv > 0) {
+            std::cout << "multipv " << multipv << ' ';
+        }
+
         std::cout << "eval " << eval << ' ';
         std::cout << "time " << time << ' ';
         std::cout << "pv";
@@ -156,4 +176,16 @@ namespace messages {
 
         std::cout << std::endl;
     }
+
+    void perft(game::Move move, std::uint64_t nodes) {
+        std::lock_guard lock {g_mutex};
+
+        std::cout << "PERFT move " << game::move_to_string(move) << " nodes " << nodes << std::endl;
+    }
+
+    void perft(std::uint64_t nodes, double time, double nodes_per_second) {
+        std::lock_guard lock {g_mutex};
+
+        std::cout << "PERFT nodes " << nodes << " time " << time << " nps " << static_cast<std::uint64_t>(nodes_per_second) << std::endl;
+    }
 }
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <cstdint>
 
 #include "game.hpp"
 #include "parameters.hpp"
@@ -10,13 +11,17 @@
 namespace messages {
     // Messages the engine sends to GUI
     void ready();
-    void bestmove(game::Move move);
+    void bestmove(game::Move move, game::Move ponder_move = game::NULL_MOVE);
     void parameters(const std::unordered_map<std::string, parameters::Parameter>& parameters);
     void parameter(const std::string& name, const parameters::Parameter& value);
     void info(
         int nodes,
+        int quiescence_nodes,
         int transpositions,
+        int hashfull,
+        int cache_hits,
         int depth,
+        int multipv,
         evaluation::Eval eval,
         double time,
         const game::Move* pv_moves,
@@ -24,4 +29,6 @@ namespace messages {
     );
     void name();
     void board(const game::GamePosition& position);
+    void perft(game::Move move, std::uint64_t nodes);
+    void perft(std::uint64_t nodes, double time, double nodes_per_second);
 }
@@ -0,0 +1,73 @@
+#include "move_ordering.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace move_ordering {
+    // History scores stay below the counter move and killer scores
+    static constexpr int HISTORY_MAX {1 << 20};
+    static constexpr int COUNTER_MOVE_SCORE {HISTORY_MAX};
+    static constexpr int KILLER_SCORE {HISTORY_MAX + 1};
+
+    static int player_index(const game::Position& position) noexcept {
+        return position.player == game::Player::Black ? 0 : 1;
+    }
+
+    static int final_destination_index(game::Move move) noexcept {
+        return move.destination_index(move.destination_indices_size() - 1);
+    }
+
+    void MoveOrdering::update(const game::Position& position, int plies_root, game::Move move, game::Move previous_move, int depth) noexcept {
+        assert(plies_root < game::MAX_PLY);
+        assert(move != game::NULL_MOVE);
+
+        game::Move (&killers)[KILLERS] {m_killers[plies_root]};
+
+        if (killers[0] != move) {
+            killers[1] = killers[0];
+            killers[0] = move;
+        }
+
+        if (previous_move != game::NULL_MOVE) {
+            m_counter_moves[previous_move.source_index()][final_destination_index(previous_move)] = move;
+        }
+
+        // Deeper cutoffs are more valuable; captures beyond the max depth still count a bit
+        const int bonus {std::max(depth, 1) * std::max(depth, 1)};
+
+        int (&history)[32][32] {m_history[player_index(position)]};
+        int& value {history[move.source_index()][final_destination_index(move)]};
+
+        value += bonus;
+
+        // Keep the scores in range, preserving their order
+        if (value >= HISTORY_MAX) {
+            for (auto& destinations : history) {
+                for (int& destination : destinations) {
+                    destination /= 2;
+                }
+            }
+        }
+    }
+
+    int MoveOrdering::score(const game::Position& position, int plies_root, game::Move move, game::Move previous_move) const noexcept {
+        assert(plies_root < game::MAX_PLY);
+
+        if (move == m_killers[plies_root][0]) {
+            return KILLER_SCORE + 1;
+        }
+
+        if (move == m_killers[plies_root][1]) {
+            return KILLER_SCORE;
+        }
+
+        if (
+            previous_move != game::NULL_MOVE &&
+            move == m_counter_moves[previous_move.source_index()][final_destination_index(previous_move)]
+        ) {
+            return COUNTER_MOVE_SCORE;
+        }
+
+        return m_history[player_index(position)][move.source_index()][final_destination_index(move)];
+    }
+}
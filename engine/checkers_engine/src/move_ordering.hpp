@@ -0,0 +1,29 @@
+#pragma once
+
+#include "game.hpp"
+
+// https://www.chessprogramming.org/Killer_Heuristic
+// https://www.chessprogramming.org/History_Heuristic
+// https://www.chessprogramming.org/Countermove_Heuristic
+
+namespace move_ordering {
+    // What the search learned about the moves that caused cutoffs, used to order the moves of other nodes
+    class MoveOrdering {
+    public:
+        // Called on every beta cutoff
+        void update(const game::Position& position, int plies_root, game::Move move, game::Move previous_move, int depth) noexcept;
+
+        // Higher is searched earlier; the killers first, then the counter move, then by history
+        int score(const game::Position& position, int plies_root, game::Move move, game::Move previous_move) const noexcept;
+    private:
+        static constexpr int KILLERS {2};
+
+        game::Move m_killers[game::MAX_PLY][KILLERS] {};
+
+        // Indexed by player, source square and final destination square
+        int m_history[2][32][32] {};
+
+        // Indexed by the source square and final destination square of the opponent's previous move
+        game::Move m_counter_moves[32][32] {};
+    };
+}
@@ -0,0 +1,132 @@
+#include "move_picker.hpp"
+
+#include <algorithm>
+
+namespace move_picker {
+    MovePicker::MovePicker(
+        const game::Position& position,
+        bool capture_moves,
+        game::Move pv_move,
+        game::Move hash_move,
+        const move_ordering::MoveOrdering& move_ordering,
+        int plies_root,
+        game::Move previous_move
+    ) noexcept
+        : m_position(position), m_capture_moves(capture_moves), m_pv_move(pv_move), m_hash_move(hash_move),
+        m_move_ordering(move_ordering), m_plies_root(plies_root), m_previous_move(previous_move) {}
+
+    game::Move MovePicker::next() noexcept {
+        switch (m_stage) {
+            case Stage::PvMove:
+                m_stage = Stage::HashMove;
+
+                if (m_pv_move != game::NULL_MOVE) {
+                    if (is_move_legal(m_pv_move)) {
+                        return m_pv_move;
+                    }
+
+                    m_pv_move = game::NULL_MOVE;
+                }
+
+                [[fallthrough]];
+            case Stage::HashMove:
+                m_stage = Stage::Generate;
+
+                // The hash move may be the PV move, which is already picked
+                if (m_hash_move != game::NULL_MOVE && m_hash_move != m_pv_move) {
+                    if (is_move_legal(m_hash_move)) {
+                        return m_hash_move;
+                    }
+
+                    m_hash_move = game::NULL_MOVE;
+                }
+
+                [[fallthrough]];
+            case Stage::Generate:
+                m_stage = Stage::Moves;
+
+                generate_moves();
+                score_moves();
+
+                [[fallthrough]];
+            case Stage::Moves:
+                while (m_index < m_moves.size()) {
+                    // Selection sort, as the rest of the moves are often not needed after a cutoff
+                    // Moves with equal scores stay in generation order
+                    int best_index {m_index};
+
+                    for (int i {m_index + 1}; i < m_moves.size(); i++) {
+                        if (m_scores[i] > m_scores[best_index]) {
+                            best_index = i;
+                        }
+                    }
+
+                    const game::Move move {m_moves[best_index]};
+                    const int score {m_scores[best_index]};
+
+                    for (int i {best_index}; i > m_index; i--) {
+                        m_moves[i] = m_moves[i - 1];
+                        m_scores[i] = m_scores[i - 1];
+                    }
+
+                    m_moves[m_index] = move;
+                    m_scores[m_index] = score;
+                    m_index++;
+
+                    if (!already_picked(move)) {
+                        return move;
+                    }
+                }
+
+                m_stage = Stage::Done;
+
+                [[fallthrough]];
+            case Stage::Done:
+                break;
+        }
+
+        return game::NULL_MOVE;
+    }
+
+    bool MovePicker::is_move_legal(game::Move move) noexcept {
+        // The move may come from anywhere, so check it against the capture rule first
+
+        if (m_capture_moves) {
+            if (!game::is_move_capture(move)) {
+                return false;
+            }
+
+            // The captures are going to be needed anyway
+            generate_moves();
+
+            return std::find(m_moves.begin(), m_moves.end(), move) != m_moves.end();
+        } else {
+            // This doesn't need any generation
+            return moves::is_normal_move_legal(m_position, move);
+        }
+    }
+
+    bool MovePicker::already_picked(game::Move move) const noexcept {
+        return move == m_pv_move || move == m_hash_move;
+    }
+
+    void MovePicker::score_moves() noexcept {
+        for (int i {0}; i < m_moves.size(); i++) {
+            m_scores[i] = m_move_ordering.score(m_position, m_plies_root, m_moves[i], m_previous_move);
+        }
+    }
+
+    void MovePicker::generate_moves() noexcept {
+        if (m_generated) {
+            return;
+        }
+
+        m_generated = true;
+
+        if (m_capture_moves) {
+            moves::generate_capture_moves(m_position, m_moves);
+        } else {
+            moves::generate_normal_moves(m_position, m_moves);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "game.hpp"
+#include "moves.hpp"
+#include "move_ordering.hpp"
+
+// https://www.chessprogramming.org/Move_Generation#Staged_move_generation
+// https://www.chessprogramming.org/Move_Ordering
+
+namespace move_picker {
+    // Hands out the moves of a position one by one, generating them only when needed
+    // First the PV move and the hash move, then the captures or the normal moves, best scored first
+    class MovePicker {
+    public:
+        MovePicker(
+            const game::Position& position,
+            bool capture_moves,
+            game::Move pv_move,
+            game::Move hash_move,
+            const move_ordering::MoveOrdering& move_ordering,
+            int plies_root,
+            game::Move previous_move
+        ) noexcept;
+
+        // Return null when there are no moves left
+        game::Move next() noexcept;
+    private:
+        enum class Stage {
+            PvMove,
+            HashMove,
+            Generate,
+            Moves,
+            Done
+        };
+
+        bool is_move_legal(game::Move move) noexcept;
+        bool already_picked(game::Move move) const noexcept;
+        void generate_moves() noexcept;
+        void score_moves() noexcept;
+
+        const game::Position& m_position;
+        bool m_capture_moves {};
+        bool m_generated {false};
+        game::Move m_pv_move {};
+        game::Move m_hash_move {};
+        const move_ordering::MoveOrdering& m_move_ordering;
+        int m_plies_root {};
+        game::Move m_previous_move {};
+        Stage m_stage {Stage::PvMove};
+        int m_index {0};
+        moves::Moves m_moves;
+        int m_scores[moves::MAX_MOVES] {};
+    };
+}
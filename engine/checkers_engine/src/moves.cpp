@@ -1,103 +1,57 @@
 #include "moves.hpp"
 
-#include <algorithm>
-#include <utility>
 #include <type_traits>
 #include <cassert>
 
+#include "bitboard.hpp"
+#include "tables.hpp"
 #include "utils.hpp"
 
 /*
     capture loop W:B1,2,3,26,18,17,25:WK30,28
 */
 
-namespace moves {
-    enum class Direction {
-        NorthEast,
-        NorthWest,
-        SouthEast,
-        SouthWest
-    };
+// https://www.3dkingdoms.com/checkers/bitboards.htm
 
-    enum class Diagonal : int {
-        Short = 1,
-        Long = 2
-    };
+namespace moves {
+    using bitboard::Bitboard;
+    using bitboard::Direction;
 
     struct JumpCtx {
-        game::Board board {};  // Use a copy of the board
+        // Use copies of the bitboards
+        Bitboard enemy {};
+        Bitboard empty {};
         int source_index {};
         array::Array<int, 9> destination_indices;
     };
 
-    template<Direction Dir, Diagonal Diag>
-    static int offset(int square_index) noexcept {
-        int result_index {square_index};
-
-        const bool even_row {(square_index / 4) % 2 == 0};
-
-        switch (Dir) {
-            case Direction::NorthEast:
-                result_index -= even_row ? 3 : 4;
-
-                if constexpr (Diag == Diagonal::Long) {
-                    result_index -= even_row ? 4 : 3;
-                }
-
-                break;
-            case Direction::NorthWest:
-                result_index -= even_row ? 4 : 5;
-
-                if constexpr (Diag == Diagonal::Long) {
-                    result_index -= even_row ? 5 : 4;
-                }
-
-                break;
-            case Direction::SouthEast:
-                result_index += even_row ? 5 : 4;
-
-                if constexpr (Diag == Diagonal::Long) {
-                    result_index += even_row ? 4 : 5;
-                }
-
-                break;
-            case Direction::SouthWest:
-                result_index += even_row ? 4 : 3;
-
-                if constexpr (Diag == Diagonal::Long) {
-                    result_index += even_row ? 3 : 4;
-                }
-
-                break;
-        }
-
-        // Check edge cases (literally)
-        if (std::abs(square_index / 4 - result_index / 4) != static_cast<std::underlying_type_t<Diagonal>>(Diag)) {
-            return game::NULL_INDEX;
-        }
-
-        // Check out of bounds
-        if (result_index < 0 || result_index > 31) {
-            return game::NULL_INDEX;
-        }
+    template<Direction Dir>
+    static Bitboard jumpers(Bitboard pieces, Bitboard enemy, Bitboard empty) noexcept {
+        // Pieces that can capture in that direction
+        return bitboard::shift<bitboard::opposite<Dir>()>(bitboard::shift<bitboard::opposite<Dir>()>(empty) & enemy) & pieces;
+    }
 
-        return result_index;
+    template<Direction Dir>
+    static Bitboard movers(Bitboard pieces, Bitboard empty) noexcept {
+        // Pieces that can step in that direction
+        return bitboard::shift<bitboard::opposite<Dir>()>(empty) & pieces;
     }
 
     static bool check_piece_jumps(JumpCtx& ctx, int square_index, game::Player player, bool king, Moves& moves) noexcept;
 
     template<Direction Dir, bool King>
-    static void check_square_capture_move(JumpCtx& ctx, int square_index, game::Player player, std::underlying_type_t<game::Square> piece_mask, bool& sequence_jumps_ended, Moves& moves) noexcept {
-        const int enemy_index {offset<Dir, Diagonal::Short>(square_index)};
-        const int target_index {offset<Dir, Diagonal::Long>(square_index)};
+    static void check_square_capture_move(JumpCtx& ctx, int square_index, game::Player player, bool& sequence_jumps_ended, Moves& moves) noexcept {
+        const auto [enemy_index, target_index] {tables::jump<Dir>(square_index)};
 
-        if (enemy_index == game::NULL_INDEX || target_index == game::NULL_INDEX) {
+        // The jumped square is also null in this case
+        if (target_index == game::NULL_INDEX) {
             return;
         }
 
-        const bool is_enemy_piece {static_cast<bool>(static_cast<std::underlying_type_t<game::Square>>(ctx.board[enemy_index]) & piece_mask)};
+        const Bitboard enemy_piece {bitboard::bit(enemy_index)};
+        const Bitboard target {bitboard::bit(target_index)};
 
-        if (!is_enemy_piece || ctx.board[target_index] != game::Square::None) {
+        if (!(ctx.enemy & enemy_piece) || !(ctx.empty & target)) {
             return;
         }
 
@@ -105,11 +59,10 @@ namespace moves {
 
         ctx.destination_indices.push_back(target_index);
 
-        // Remove the piece to avoid illegal jumps
-        const auto removed_enemy_piece {std::exchange(ctx.board[enemy_index], game::Square::None)};
-
+        // Remove the enemy piece to avoid illegal jumps
         // Jump this piece to avoid other illegal jumps
-        std::swap(ctx.board[square_index], ctx.board[target_index]);
+        ctx.enemy ^= enemy_piece;
+        ctx.empty ^= bitboard::bit(square_index) | enemy_piece | target;
 
         if (check_piece_jumps(ctx, target_index, player, King, moves)) {
             // This means that it reached the end of a sequence of jumps; the piece can't jump anymore
@@ -123,19 +76,14 @@ namespace moves {
             moves.emplace_back(ctx.source_index, destination_indices, ctx.destination_indices.size());
         }
 
-        // Restore jumped piece
-        std::swap(ctx.board[square_index], ctx.board[target_index]);
-
-        // Restore removed piece
-        ctx.board[enemy_index] = removed_enemy_piece;
+        // Restore the jumped piece and the removed piece
+        ctx.enemy ^= enemy_piece;
+        ctx.empty ^= bitboard::bit(square_index) | enemy_piece | target;
 
         ctx.destination_indices.pop_back();
     }
 
     static bool check_piece_jumps(JumpCtx& ctx, int square_index, game::Player player, bool king, Moves& moves) noexcept {
-        // We want an enemy piece
-        const auto piece_mask {static_cast<std::underlying_type_t<game::Player>>(game::opponent(player))};
-
         bool sequence_jumps_ended {true};
 
         // Check the squares above or below in diagonal
@@ -144,19 +92,19 @@ namespace moves {
                 assert(false);
                 utils::unreachable();
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::Black):
-                check_square_capture_move<Direction::SouthEast, false>(ctx, square_index, player, piece_mask, sequence_jumps_ended, moves);
-                check_square_capture_move<Direction::SouthWest, false>(ctx, square_index, player, piece_mask, sequence_jumps_ended, moves);
+                check_square_capture_move<Direction::SouthEast, false>(ctx, square_index, player, sequence_jumps_ended, moves);
+                check_square_capture_move<Direction::SouthWest, false>(ctx, square_index, player, sequence_jumps_ended, moves);
                 break;
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::White):
-                check_square_capture_move<Direction::NorthEast, false>(ctx, square_index, player, piece_mask, sequence_jumps_ended, moves);
-                check_square_capture_move<Direction::NorthWest, false>(ctx, square_index, player, piece_mask, sequence_jumps_ended, moves);
+                check_square_capture_move<Direction::NorthEast, false>(ctx, square_index, player, sequence_jumps_ended, moves);
+                check_square_capture_move<Direction::NorthWest, false>(ctx, square_index, player, sequence_jumps_ended, moves);
                 break;
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::WhiteKing):
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::BlackKing):
-                check_square_capture_move<Direction::NorthEast, true>(ctx, square_index, player, piece_mask, sequence_jumps_ended, moves);
-                check_square_capture_move<Direction::NorthWest, true>(ctx, square_index, player, piece_mask, sequence_jumps_ended, moves);
-                check_square_capture_move<Direction::SouthEast, true>(ctx, square_index, player, piece_mask, sequence_jumps_ended, moves);
-                check_square_capture_move<Direction::SouthWest, true>(ctx, square_index, player, piece_mask, sequence_jumps_ended, moves);
+                check_square_capture_move<Direction::NorthEast, true>(ctx, square_index, player, sequence_jumps_ended, moves);
+                check_square_capture_move<Direction::NorthWest, true>(ctx, square_index, player, sequence_jumps_ended, moves);
+                check_square_capture_move<Direction::SouthEast, true>(ctx, square_index, player, sequence_jumps_ended, moves);
+                check_square_capture_move<Direction::SouthWest, true>(ctx, square_index, player, sequence_jumps_ended, moves);
                 break;
         }
 
@@ -165,21 +113,22 @@ namespace moves {
 
     static void generate_piece_capture_moves(const game::Position& position, int square_index, bool king, Moves& moves) noexcept {
         JumpCtx ctx;
-        ctx.board = position.board;
+        ctx.enemy = game::pieces(position, game::opponent(position.player));
+        ctx.empty = ~(position.black | position.white);
         ctx.source_index = square_index;
 
         check_piece_jumps(ctx, square_index, position.player, king, moves);
     }
 
     template<Direction Dir>
-    static void check_square_normal_move(const game::Board& board, int square_index, Moves& moves) noexcept {
-        const int target_index {offset<Dir, Diagonal::Short>(square_index)};
+    static void check_square_normal_move(Bitboard empty, int square_index, Moves& moves) noexcept {
+        const int target_index {tables::step<Dir>(square_index)};
 
         if (target_index == game::NULL_INDEX) {
             return;
         }
 
-        if (board[target_index] != game::Square::None) {
+        if (!(empty & bitboard::bit(target_index))) {
             return;
         }
 
@@ -187,49 +136,182 @@ namespace moves {
     }
 
     static void generate_piece_normal_moves(const game::Position& position, int square_index, bool king, Moves& moves) noexcept {
+        const Bitboard empty {~(position.black | position.white)};
+
         // Check the squares above or below in diagonal
         switch (static_cast<std::underlying_type_t<game::Player>>(position.player) | static_cast<std::underlying_type_t<game::Player>>(king) << 2) {
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::None):
                 assert(false);
                 utils::unreachable();
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::Black):
-                check_square_normal_move<Direction::SouthEast>(position.board, square_index, moves);
-                check_square_normal_move<Direction::SouthWest>(position.board, square_index, moves);
+                check_square_normal_move<Direction::SouthEast>(empty, square_index, moves);
+                check_square_normal_move<Direction::SouthWest>(empty, square_index, moves);
                 break;
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::White):
-                check_square_normal_move<Direction::NorthEast>(position.board, square_index, moves);
-                check_square_normal_move<Direction::NorthWest>(position.board, square_index, moves);
+                check_square_normal_move<Direction::NorthEast>(empty, square_index, moves);
+                check_square_normal_move<Direction::NorthWest>(empty, square_index, moves);
                 break;
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::WhiteKing):
             case static_cast<std::underlying_type_t<game::Square>>(game::Square::BlackKing):
-                check_square_normal_move<Direction::NorthEast>(position.board, square_index, moves);
-                check_square_normal_move<Direction::NorthWest>(position.board, square_index, moves);
-                check_square_normal_move<Direction::SouthEast>(position.board, square_index, moves);
-                check_square_normal_move<Direction::SouthWest>(position.board, square_index, moves);
+                check_square_normal_move<Direction::NorthEast>(empty, square_index, moves);
+                check_square_normal_move<Direction::NorthWest>(empty, square_index, moves);
+                check_square_normal_move<Direction::SouthEast>(empty, square_index, moves);
+                check_square_normal_move<Direction::SouthWest>(empty, square_index, moves);
                 break;
         }
     }
 
+    static Bitboard capture_pieces(const game::Position& position) noexcept {
+        // All the pieces of the current player that have at least one capture available
+
+        const Bitboard pieces {game::pieces(position, position.player)};
+        const Bitboard enemy {game::pieces(position, game::opponent(position.player))};
+        const Bitboard empty {~(position.black | position.white)};
+        const Bitboard kings {pieces & position.kings};
+
+        Bitboard result {
+            jumpers<Direction::NorthEast>(kings, enemy, empty) |
+            jumpers<Direction::NorthWest>(kings, enemy, empty) |
+            jumpers<Direction::SouthEast>(kings, enemy, empty) |
+            jumpers<Direction::SouthWest>(kings, enemy, empty)
+        };
+
+        switch (position.player) {
+            case game::Player::Black:
+                result |= jumpers<Direction::SouthEast>(pieces, enemy, empty);
+                result |= jumpers<Direction::SouthWest>(pieces, enemy, empty);
+                break;
+            case game::Player::White:
+                result |= jumpers<Direction::NorthEast>(pieces, enemy, empty);
+                result |= jumpers<Direction::NorthWest>(pieces, enemy, empty);
+                break;
+        }
+
+        return result;
+    }
+
+    static Bitboard normal_pieces(const game::Position& position) noexcept {
+        // All the pieces of the current player that have at least one normal move available
+
+        const Bitboard pieces {game::pieces(position, position.player)};
+        const Bitboard empty {~(position.black | position.white)};
+        const Bitboard kings {pieces & position.kings};
+
+        Bitboard result {
+            movers<Direction::NorthEast>(kings, empty) |
+            movers<Direction::NorthWest>(kings, empty) |
+            movers<Direction::SouthEast>(kings, empty) |
+            movers<Direction::SouthWest>(kings, empty)
+        };
+
+        switch (position.player) {
+            case game::Player::Black:
+                result |= movers<Direction::SouthEast>(pieces, empty);
+                result |= movers<Direction::SouthWest>(pieces, empty);
+                break;
+            case game::Player::White:
+                result |= movers<Direction::NorthEast>(pieces, empty);
+                result |= movers<Direction::NorthWest>(pieces, empty);
+                break;
+        }
+
+        return result;
+    }
+
+    template<Direction Dir>
+    static bool is_step(int source_index, int destination_index) noexcept {
+        return tables::step<Dir>(source_index) == destination_index;
+    }
+
     Moves generate_moves(const game::Position& position) noexcept {
         Moves moves;
 
-        for (int i {0}; i < 32; i++) {
-            if (game::is_piece(position.board[i], position.player)) {
-                generate_piece_capture_moves(position, i, game::is_king_piece(position.board[i]), moves);
-            }
-        }
+        generate_capture_moves(position, moves);
 
         // If there are possible captures, force the player to play these moves
         if (!moves.empty()) {
             return moves;
         }
 
-        for (int i {0}; i < 32; i++) {
-            if (game::is_piece(position.board[i], position.player)) {
-                generate_piece_normal_moves(position, i, game::is_king_piece(position.board[i]), moves);
-            }
-        }
+        generate_normal_moves(position, moves);
 
         return moves;
     }
+
+    void generate_capture_moves(const game::Position& position, Moves& moves) noexcept {
+        // Pieces are visited in the order of their indices, in order to preserve the order of the moves
+
+        Bitboard pieces {capture_pieces(position)};
+
+        while (pieces != bitboard::EMPTY) {
+            const int index {bitboard::pop_index(pieces)};
+            generate_piece_capture_moves(position, index, position.kings & bitboard::bit(index), moves);
+        }
+    }
+
+    void generate_normal_moves(const game::Position& position, Moves& moves) noexcept {
+        // Pieces are visited in the order of their indices, in order to preserve the order of the moves
+
+        Bitboard pieces {normal_pieces(position)};
+
+        while (pieces != bitboard::EMPTY) {
+            const int index {bitboard::pop_index(pieces)};
+            generate_piece_normal_moves(position, index, position.kings & bitboard::bit(index), moves);
+        }
+    }
+
+    bool has_capture_moves(const game::Position& position) noexcept {
+        return capture_pieces(position) != bitboard::EMPTY;
+    }
+
+    bool has_normal_moves(const game::Position& position) noexcept {
+        return normal_pieces(position) != bitboard::EMPTY;
+    }
+
+    bool is_normal_move_legal(const game::Position& position, game::Move move) noexcept {
+        // Captures must be ruled out beforehand
+
+        if (move.type() != game::MoveType::Normal) {
+            return false;
+        }
+
+        const int source_index {move.source_index()};
+        const int destination_index {move.destination_index()};
+
+        // Reject anything that is not exactly how the generator would encode it
+        if (move != game::Move(source_index, destination_index)) {
+            return false;
+        }
+
+        if (!(game::pieces(position, position.player) & bitboard::bit(source_index))) {
+            return false;
+        }
+
+        if ((position.black | position.white) & bitboard::bit(destination_index)) {
+            return false;
+        }
+
+        const bool north {
+            is_step<Direction::NorthEast>(source_index, destination_index) ||
+            is_step<Direction::NorthWest>(source_index, destination_index)
+        };
+
+        const bool south {
+            is_step<Direction::SouthEast>(source_index, destination_index) ||
+            is_step<Direction::SouthWest>(source_index, destination_index)
+        };
+
+        if (position.kings & bitboard::bit(source_index)) {
+            return north || south;
+        }
+
+        switch (position.player) {
+            case game::Player::Black:
+                return south;
+            case game::Player::White:
+                return north;
+        }
+
+        return false;
+    }
 }
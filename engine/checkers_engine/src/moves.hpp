@@ -4,7 +4,16 @@
 #include "array.hpp"
 
 namespace moves {
-    using Moves = array::Array<game::Move, 35>;
+    inline constexpr int MAX_MOVES {35};
+
+    using Moves = array::Array<game::Move, MAX_MOVES>;
 
     Moves generate_moves(const game::Position& position) noexcept;
+
+    // Captures are forced, so normal moves are legal only when there are no captures available
+    void generate_capture_moves(const game::Position& position, Moves& moves) noexcept;
+    void generate_normal_moves(const game::Position& position, Moves& moves) noexcept;
+    bool has_capture_moves(const game::Position& position) noexcept;
+    bool has_normal_moves(const game::Position& position) noexcept;
+    bool is_normal_move_legal(const game::Position& position, game::Move move) noexcept;
 }
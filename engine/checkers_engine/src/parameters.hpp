@@ -19,5 +19,12 @@ namespace parameters {
         Int positioning_pawn {};
         Int positioning_king {};
         Int crowdness {};
+        Bool pvs {};
+        Bool lmr {};
+        Int lmr_depth {};
+        Int lmr_moves {};
+        Float lmr_base {};
+        Float lmr_div {};
+        Int multipv {};
     };
 }
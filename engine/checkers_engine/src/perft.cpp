@@ -0,0 +1,163 @@
+#include "perft.hpp"
+
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cassert>
+
+#include "moves.hpp"
+
+namespace perft {
+    class HashTable {
+    public:
+        explicit HashTable(std::size_t size_bytes) {
+            std::size_t size {1};
+
+            while (size * 2 * sizeof(Entry) <= size_bytes) {
+                size *= 2;
+            }
+
+            m_entries = std::make_unique<Entry[]>(size);
+            m_mask = size - 1;
+        }
+
+        bool load(game::PositionKey key, int depth, std::uint64_t& nodes) const noexcept {
+            const Entry& entry {m_entries[key & m_mask]};
+
+            const std::uint64_t data {entry.data.load(std::memory_order_relaxed)};
+            const std::uint64_t key_data {entry.key_data.load(std::memory_order_relaxed)};
+
+            // A torn or a different entry doesn't pass this check
+            if ((key_data ^ data) != key || static_cast<int>(data & 0xFFu) != depth) {
+                return false;
+            }
+
+            nodes = data >> 8;
+
+            return true;
+        }
+
+        void store(game::PositionKey key, int depth, std::uint64_t nodes) noexcept {
+            // Counts that don't fit are simply not stored
+            if (nodes >> 56 != 0) {
+                return;
+            }
+
+            Entry& entry {m_entries[key & m_mask]};
+
+            const std::uint64_t data {nodes << 8 | static_cast<std::uint64_t>(depth)};
+
+            entry.key_data.store(key ^ data, std::memory_order_relaxed);
+            entry.data.store(data, std::memory_order_relaxed);
+        }
+    private:
+        struct Entry {
+            std::atomic<std::uint64_t> key_data {0};
+            std::atomic<std::uint64_t> data {0};
+        };
+
+        std::unique_ptr<Entry[]> m_entries;
+        std::size_t m_mask {0};
+    };
+
+    static std::uint64_t count_nodes(const game::GamePosition& position, int depth, HashTable* table) noexcept {
+        if (depth == 0) {
+            return 1;
+        }
+
+        const auto moves {moves::generate_moves(position)};
+
+        // Don't play the moves on the last ply
+        if (depth == 1) {
+            return static_cast<std::uint64_t>(moves.size());
+        }
+
+        std::uint64_t nodes {0};
+
+        if (table != nullptr && table->load(position.key, depth, nodes)) {
+            return nodes;
+        }
+
+        for (const game::Move move : moves) {
+            game::GamePosition new_position {position};
+            game::play_move_bare(new_position, move);
+
+            nodes += count_nodes(new_position, depth - 1, table);
+        }
+
+        if (table != nullptr) {
+            table->store(position.key, depth, nodes);
+        }
+
+        return nodes;
+    }
+
+    Result perft(const game::GamePosition& position, int depth, int threads, std::size_t hash_size_bytes) {
+        assert(depth >= 0);
+
+        Result result;
+
+        std::unique_ptr<HashTable> table;
+
+        if (hash_size_bytes > 0) {
+            table = std::make_unique<HashTable>(hash_size_bytes);
+        }
+
+        const auto begin {std::chrono::steady_clock::now()};
+
+        if (depth == 0) {
+            result.nodes = 1;
+        } else {
+            const auto moves {moves::generate_moves(position)};
+
+            for (const game::Move move : moves) {
+                result.root_moves.emplace_back(move, 0);
+            }
+
+            // Every thread takes the next root move that is not yet taken
+            std::atomic<std::size_t> next_move {0};
+
+            const auto work {[&]() noexcept {
+                while (true) {
+                    const std::size_t index {next_move.fetch_add(1)};
+
+                    if (index >= result.root_moves.size()) {
+                        break;
+                    }
+
+                    auto& [move, nodes] {result.root_moves[index]};
+
+                    game::GamePosition new_position {position};
+                    game::play_move_bare(new_position, move);
+
+                    nodes = count_nodes(new_position, depth - 1, table.get());
+                }
+            }};
+
+            std::vector<std::thread> workers;
+
+            for (int i {1}; i < std::max(threads, 1); i++) {
+                workers.emplace_back(work);
+            }
+
+            // This thread works too
+            work();
+
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+
+            for (const auto& [_, nodes] : result.root_moves) {
+                result.nodes += nodes;
+            }
+        }
+
+        const auto end {std::chrono::steady_clock::now()};
+
+        result.time = std::chrono::duration<double>(end - begin).count();
+
+        return result;
+    }
+}
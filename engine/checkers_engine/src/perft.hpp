@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+#include "game.hpp"
+
+// https://www.chessprogramming.org/Perft
+// https://www.chessprogramming.org/Shared_Hash_Table#Lockless
+
+namespace perft {
+    struct Result {
+        std::uint64_t nodes {0};  // Leaf nodes
+        double time {};  // Seconds
+        std::vector<std::pair<game::Move, std::uint64_t>> root_moves;  // Leaf nodes for every root move, in order
+    };
+
+    // Count the leaf nodes of the tree at that depth
+    // Root moves are split between the threads; the hash table is shared and it's optional (size 0)
+    Result perft(const game::GamePosition& position, int depth, int threads, std::size_t hash_size_bytes);
+
+    constexpr double nodes_per_second(const Result& result) noexcept {
+        return result.time > 0.0 ? static_cast<double>(result.nodes) / result.time : 0.0;
+    }
+}
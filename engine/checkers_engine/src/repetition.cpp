@@ -0,0 +1,59 @@
+#include "repetition.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace repetition {
+    void History::clear() noexcept {
+        m_keys.clear();
+        m_signatures.clear();
+        std::memset(m_filter, 0, sizeof(m_filter));
+    }
+
+    void History::push(game::PositionKey key, game::PositionSignature signature) noexcept {
+        m_keys.push_back(key);
+        m_signatures.push_back(signature);
+        m_filter[filter_index(key)]++;
+    }
+
+    void History::pop() noexcept {
+        assert(!m_keys.empty());
+
+        m_filter[filter_index(m_keys.back())]--;
+        m_keys.pop_back();
+        m_signatures.pop_back();
+    }
+
+    bool History::is_threefold_repetition(int plies_without_advancement) const noexcept {
+        assert(!m_keys.empty());
+
+        const game::PositionKey key {m_keys.back()};
+
+        // Most of the positions are rejected right here
+        if (m_filter[filter_index(key)] < 3) {
+            return false;
+        }
+
+        // Only the positions since the last advancement can repeat
+        const int last {m_keys.size() - 1};
+        const int first {last - std::min(plies_without_advancement, last)};
+
+        int repetitions {1};
+
+        // Only every other position has the same player to move
+        for (int i {last - 2}; i >= first; i -= 2) {
+            if (m_keys[i] != key) {
+                continue;
+            }
+
+            if (m_signatures[i] == m_signatures[last]) {
+                if (++repetitions == 3) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include "game.hpp"
+#include "array.hpp"
+
+// https://www.chessprogramming.org/Repetitions
+
+namespace repetition {
+    // The current and previous positions of the game and of the search (for threefold repetition)
+    // position0, position1, position2, ..., positionN (current)
+    class History {
+    public:
+        void clear() noexcept;
+        void push(game::PositionKey key, game::PositionSignature signature) noexcept;
+        void pop() noexcept;
+
+        // Check if the current position has occurred two more times since the last advancement
+        bool is_threefold_repetition(int plies_without_advancement) const noexcept;
+    private:
+        static constexpr int SIZE {81 + game::MAX_PLY};
+        static constexpr int FILTER_SIZE {1024};
+
+        static constexpr std::size_t filter_index(game::PositionKey key) noexcept {
+            return static_cast<std::size_t>(key & (FILTER_SIZE - 1));
+        }
+
+        // Keys are compared first and signatures only on a match
+        array::Array<game::PositionKey, SIZE> m_keys;
+        array::Array<game::PositionSignature, SIZE> m_signatures;
+
+        // Number of positions in the history for every key slot
+        // A position can't repeat three times, if there aren't at least three in its slot
+        std::uint8_t m_filter[FILTER_SIZE] {};
+    };
+}
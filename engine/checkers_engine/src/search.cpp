@@ -1,12 +1,15 @@
 #include "search.hpp"
 
 #include <algorithm>
-#include <utility>
-#include <iterator>
+#include <thread>
 #include <cstring>
+#include <cmath>
 #include <cassert>
 
 #include "messages.hpp"
+#include "moves.hpp"
+#include "utils.hpp"
+#include "frozen_parameters.hpp"
 
 // https://web.archive.org/web/20071030220820/http://www.brucemo.com/compchess/programming/minmax.htm
 // https://web.archive.org/web/20071030084528/http://www.brucemo.com/compchess/programming/alphabeta.htm
@@ -17,15 +20,43 @@
 // https://web.archive.org/web/20071027170528/http://www.brucemo.com/compchess/programming/quiescent.htm
 // https://web.archive.org/web/20071031095918/http://www.brucemo.com/compchess/programming/aspiration.htm
 // https://www.chessprogramming.org/Aspiration_Windows
+// https://www.chessprogramming.org/Young_Brothers_Wait_Concept
+// https://www.chessprogramming.org/Principal_Variation_Search
+// https://www.chessprogramming.org/Node_Types
+// https://www.chessprogramming.org/Late_Move_Reductions
+
 
 namespace search {
+    // Splitting shallower nodes is not worth the overhead
+    static constexpr int MIN_SPLIT_DEPTH {4};
+
+    static NodeType first_child_node_type(NodeType node_type) noexcept {
+        switch (node_type) {
+            case NodeType::Pv:
+                return NodeType::Pv;
+            case NodeType::Cut:
+                return NodeType::All;
+            case NodeType::All:
+                return NodeType::Cut;
+        }
+
+        utils::unreachable();
+    }
+
     Search::Search(
         int search_sequence,
         const parameters::Parameters& parameters,
-        transposition_table::TranspositionTable& transposition_table
+        transposition_table::TranspositionTable& transposition_table,
+        std::atomic_bool& should_stop,
+        const std::atomic_bool& ponder,
+        int thread_index
     ) noexcept
-        : m_search_sequence(search_sequence), m_transposition_table(transposition_table) {
+        : m_should_stop(should_stop), m_ponder(ponder), m_search_sequence(search_sequence), m_thread_index(thread_index),
+        m_transposition_table(transposition_table) {
         setup_parameters(parameters);
+
+        // Helpers have no result to return, so they can stop at any time
+        m_can_stop = m_thread_index != 0;
     }
 
     game::Move Search::search(
@@ -33,65 +64,71 @@ namespace search {
         const std::vector<game::GamePosition>& previous_positions,
         const std::vector<game::Move>& moves_played,
         int max_depth,
-        double max_time
+        const time_manager::Limits& limits
     ) noexcept {
         // The TT is not cleared between moves, but only between games
         // The ply of the moves is used to identify old TT entries
 
-        const game::SearchNode& current_node {setup_nodes(position, previous_positions, moves_played)};
+        // Pondering is not limited until the ponder hit
+        m_pondering = m_ponder.load(std::memory_order_relaxed);
+        m_limits = limits;
+        m_time_manager.start(m_pondering ? time_manager::Limits() : m_limits, std::chrono::steady_clock::now());
+
+        setup_position(position, previous_positions, moves_played);
 
-        game::PvLine last_pv_line;
+        const moves::Moves root_moves {moves::generate_moves(m_position)};
 
-        evaluation::Eval alpha {evaluation::WINDOW_MIN};
-        evaluation::Eval beta {evaluation::WINDOW_MAX};
+        // Don't waste the clock on a forced move
+        if (m_time_manager.is_limited() && root_moves.size() == 1) {
+            return root_moves[0];
+        }
 
-        m_max_time = max_time;
-        m_begin_search = std::chrono::steady_clock::now();
+        // Only the main search reports more lines; there must be a move for every line
+        const int lines {m_thread_index == 0 ? std::clamp(std::min(m_parameters.multipv, root_moves.size()), 1, MAX_MULTIPV) : 1};
 
-        for (int depth {1}; depth <= std::min(max_depth, game::MAX_DEPTH);) {
-            game::PvLine line;
+        // Includes the searches that fell out of the window
+        auto iteration_begin {std::chrono::steady_clock::now()};
 
+        // Half of the helpers start one ply deeper, so that the threads don't search the same trees in lockstep
+        for (int depth {1 + m_thread_index % 2}; depth <= std::min(max_depth, game::MAX_DEPTH);) {
             const auto begin {std::chrono::steady_clock::now()};
 
-            const evaluation::Eval evaluation {
-                alpha_beta(depth, 0, alpha, beta, current_node, line, last_pv_line)
-            };
+            // Every line has its own window
+            RootLine& line {m_root_lines[m_pv_index]};
+
+            const evaluation::Eval evaluation {alpha_beta(depth, 0, line.alpha, line.beta, NodeType::Pv)};
 
             const auto end {std::chrono::steady_clock::now()};
 
-            check_max_time(end);
+            check_time(end);
 
-            if (m_should_stop & m_can_stop) {
+            if (is_stopped()) {
                 // Exit immediately; discard the PV, as it's probably broken
                 break;
             }
 
             // If we fell out of the window, then retry the last search with a full window
-            if (evaluation <= alpha || evaluation >= beta) {
-                alpha = evaluation::WINDOW_MIN;
-                beta = evaluation::WINDOW_MAX;
+            if (evaluation <= line.alpha || evaluation >= line.beta) {
+                line.alpha = evaluation::WINDOW_MIN;
+                line.beta = evaluation::WINDOW_MAX;
                 continue;
             }
 
             // Setup an appropriate window for the next search
-            alpha = evaluation - window_delta();
-            beta = evaluation + window_delta();
-
-            last_pv_line = line;
-
-            // This can throw, but if it does, it's game over anyway
-            messages::info(
-                m_nodes_evaluated,
-                m_transpositions,
-                depth,
-                evaluation * evaluation::perspective(current_node),
-                std::chrono::duration<double>(end - begin).count(),
-                line.moves,
-                line.size
-            );
+            line.alpha = evaluation - window_delta();
+            line.beta = evaluation + window_delta();
+
+            std::memcpy(line.pv.moves, m_pv_table[0], m_pv_size[0] * sizeof(game::Move));
+            line.pv.size = m_pv_size[0];
+            line.evaluation = evaluation;
+            line.time = std::chrono::duration<double>(end - begin).count();
+            line.nodes_evaluated = m_nodes_evaluated;
+            line.quiescence_nodes = m_quiescence_nodes;
+            line.transpositions = m_transpositions;
+            line.cache_hits = m_cache_probes > 0 ? static_cast<int>(static_cast<long long>(m_cache_hits) * 1000 / m_cache_probes) : -1;
 
             // If we got no PV, then the game must be over
-            if (line.size == 0) {
+            if (line.pv.size == 0) {
                 return game::NULL_MOVE;
             }
 
@@ -100,66 +137,101 @@ namespace search {
 
             reset_after_search_iteration();
 
+            // The next lines exclude the first moves of the previous ones
+            if (m_pv_index + 1 < lines) {
+                m_excluded_moves.push_back(line.pv.moves[0]);
+                m_pv_index++;
+                continue;
+            }
+
+            m_excluded_moves.clear();
+            m_pv_index = 0;
+
+            // A later line may still turn out better than an earlier one
+            std::stable_sort(m_root_lines, m_root_lines + lines, [](const RootLine& left, const RootLine& right) {
+                return left.evaluation > right.evaluation;
+            });
+
+            // Only the main search reports; this can throw, but if it does, it's game over anyway
+            if (m_thread_index == 0) {
+                for (int i {0}; i < lines; i++) {
+                    const RootLine& root_line {m_root_lines[i]};
+
+                    messages::info(
+                        root_line.nodes_evaluated,
+                        root_line.quiescence_nodes,
+                        root_line.transpositions,
+                        m_transposition_table.hashfull(m_search_sequence),
+                        root_line.cache_hits,
+                        depth,
+                        lines > 1 ? i + 1 : 0,
+                        root_line.evaluation * evaluation::perspective(m_position),
+                        root_line.time,
+                        root_line.pv.moves,
+                        root_line.pv.size
+                    );
+                }
+            }
+
+            // Only the main search decides when to stop
+            if (m_thread_index == 0) {
+                const double iteration_time {std::chrono::duration<double>(end - iteration_begin).count()};
+
+                if (m_time_manager.should_stop(m_root_lines[0].pv.moves[0], iteration_time, end)) {
+                    break;
+                }
+            }
+
+            iteration_begin = end;
             depth++;
         }
 
-        assert(last_pv_line.size > 0);
+        const game::PvLine& best_line {m_root_lines[0].pv};
+
+        // Helpers may be stopped before completing any iteration
+        assert(best_line.size > 0 || m_thread_index != 0);
 
-        return last_pv_line.moves[0];
+        return best_line.size > 0 ? best_line.moves[0] : game::NULL_MOVE;
     }
 
-    evaluation::Eval Search::alpha_beta(
-        int depth,
-        int plies_root,
-        evaluation::Eval alpha,
-        evaluation::Eval beta,
-        const game::SearchNode& current_node,
-        game::PvLine& p_line,
-        const game::PvLine& pv
-    ) noexcept {
-        if (m_nodes_evaluated % 70'000 == 0) {
-            // Check the time every now and then
-            check_max_time(std::chrono::steady_clock::now());
-        }
+    evaluation::Eval Search::alpha_beta(int depth, int plies_root, evaluation::Eval alpha, evaluation::Eval beta, NodeType node_type) noexcept {
+        assert(plies_root < game::MAX_PLY);
 
-        if (m_should_stop & m_can_stop) {
+        if (is_stopped()) {
             // Discard this search; this should only happen for iterations 2 onwards
             return 0;
         }
 
-        // Generate moves here, because we need to check game over condition on unavailable legal moves
+        if (depth <= 0) {
+            return quiescence(plies_root, alpha, beta);
+        }
+
+        count_node();
+
+        // Most nodes don't have a PV
+        m_pv_size[plies_root] = 0;
+
+        // Check game over condition on unavailable legal moves without generating them
         // At the same time, this also checks game over on unavailable material, 2 in 1
-        auto moves {moves::generate_moves(current_node)};
+        const bool capture_moves {moves::has_capture_moves(m_position)};
 
-        if (moves.empty()) {  // Game over
-            p_line.size = 0;
+        if (!capture_moves && !moves::has_normal_moves(m_position)) {  // Game over
             m_nodes_evaluated++;
             return evaluation::MIN + plies_root;  // Encourage the winning side to finish earlier (though rare)
         }
 
         // Then check for tie
 
-        if (game::is_forty_move_rule(current_node)) {  // Game over
-            p_line.size = 0;
+        if (game::is_forty_move_rule(m_position)) {  // Game over
             m_nodes_evaluated++;
             return 0;
         }
 
-        if (game::is_threefold_repetition_rule(current_node)) {  // Game over
-            p_line.size = 0;
+        if (is_threefold_repetition()) {  // Game over
             m_nodes_evaluated++;
             return 0;
         }
 
-        // The game is not over
-        // If we reached maximum depth and there are no captures available, return heuristic value
-        // This is a form of quiescent alpha beta
-        if (depth <= 0 && !game::is_move_capture(moves[0])) {
-            p_line.size = 0;
-            m_nodes_evaluated++;
-            return evaluation::static_evaluation(current_node, m_parameters) * evaluation::perspective(current_node);
-        }
-
         // We don't insert game over evaluations into the TT, as it may cause problems
 
         game::Move hash_move {game::NULL_MOVE};
@@ -167,13 +239,12 @@ namespace search {
         // Don't check the TT one ply from the root of the search
         if (plies_root > 1) {
             const auto [evaluation, move] {
-                m_transposition_table.load(current_node.key, current_node.signature, depth, alpha, beta)
+                m_transposition_table.load(m_position.key, depth, alpha, beta)
             };
 
             if (evaluation != evaluation::UNKNOWN) {
                 // TT may greatly disturb the PV, even making it sometimes non sensical
-                // Cut out the non-sense from the PV
-                p_line.size = 0;
+                // Cut out the non-sense from the PV; this node has no PV
 
                 m_transpositions++;
                 return evaluation;
@@ -183,29 +254,54 @@ namespace search {
             }
         }
 
-        // It's very important to reorder the moves based on the previous PV first
-        reorder_moves_pv(moves, pv, plies_root);
-
-        // Reorder based on the hash move second, which may be null, which is fine
-        reorder_moves_hash_move(moves, hash_move);
+        // It's very important to pick the move from the previous PV first
+        // Pick the hash move second, which may be null, which is fine
+        move_picker::MovePicker picker {
+            m_position,
+            capture_moves,
+            pv_move(plies_root),
+            hash_move,
+            m_move_ordering,
+            plies_root,
+            m_moves_made[plies_root]
+        };
 
-        game::PvLine line;
         auto flag {transposition_table::Flag::Alpha};
         game::Move best_move {game::NULL_MOVE};
+        int move_index {0};
+
+        while (true) {
+            const game::Move move {picker.next()};
 
-        for (const game::Move move : moves) {
-            game::SearchNode new_node;
-            game::fill_node(new_node, current_node);
+            if (move == game::NULL_MOVE) {
+                break;
+            }
 
-            game::play_move(new_node, move);
+            if (is_excluded(plies_root, move)) {
+                continue;
+            }
 
-            const evaluation::Eval evaluation {
-                -alpha_beta(depth - 1, plies_root + 1, -beta, -alpha, new_node, line, pv)
-            };
+            m_moves_made[plies_root + 1] = move;
+
+            game::MoveUndo undo;
+            make_move(move, undo);
+
+            evaluation::Eval evaluation {};
+
+            if (move_index == 0) {
+                evaluation = -alpha_beta(depth - 1, plies_root + 1, -beta, -alpha, first_child_node_type(node_type));
+            } else {
+                const int reduction {late_move_reduction(depth, move_index, node_type, move, undo)};
+                evaluation = search_younger_brother(depth, plies_root, alpha, beta, node_type, reduction);
+            }
+
+            move_index++;
+
+            unmake_move(move, undo);
 
             // We need to check for the stop flag here too, because we previously just returned 0,
             // which would have been evaluated and the move put into the TT
-            if (m_should_stop & m_can_stop) {
+            if (is_stopped()) {
                 return 0;
             }
 
@@ -215,15 +311,9 @@ namespace search {
             // Check if the move was way too good for the opponent to let us play it
             // If so, don't evaluate the rest of the moves, because the opponent will not let us get here
             if (evaluation >= beta) {
-                m_transposition_table.store(
-                    current_node.key,
-                    current_node.signature,
-                    depth,
-                    m_search_sequence,
-                    transposition_table::Flag::Beta,
-                    beta,
-                    move
-                );
+                m_move_ordering.update(m_position, plies_root, move, m_moves_made[plies_root], depth);
+
+                store_transposition(plies_root, depth, transposition_table::Flag::Beta, beta, move);
 
                 return beta;
             }
@@ -235,17 +325,342 @@ namespace search {
                 flag = transposition_table::Flag::Exact;
                 best_move = move;
 
-                fill_pv(p_line, line, move);
+                update_pv(plies_root, move);
+            }
+
+            // The eldest brother didn't cause a cutoff, so the young brothers may be searched in parallel
+            // A CUT node is still expected to cut off with one of the next few moves
+            if (m_pool != nullptr && depth >= MIN_SPLIT_DEPTH && node_type != NodeType::Cut) {
+                game::Move split_best_move {game::NULL_MOVE};
+                const evaluation::Eval split_evaluation {
+                    split(picker, depth, plies_root, alpha, beta, node_type, split_best_move)
+                };
+
+                if (is_stopped()) {
+                    return 0;
+                }
+
+                if (split_evaluation >= beta) {
+                    m_move_ordering.update(m_position, plies_root, split_best_move, m_moves_made[plies_root], depth);
+
+                    store_transposition(plies_root, depth, transposition_table::Flag::Beta, beta, split_best_move);
+
+                    return beta;
+                }
+
+                if (split_evaluation > alpha) {
+                    alpha = split_evaluation;
+
+                    flag = transposition_table::Flag::Exact;
+                    best_move = split_best_move;
+                }
+
+                break;
             }
         }
 
         // Null moves may be inserted into the TT; flags are alpha
-        m_transposition_table.store(current_node.key, current_node.signature, depth, m_search_sequence, flag, alpha, best_move);
+        store_transposition(plies_root, depth, flag, alpha, best_move);
+
+        return alpha;
+    }
+
+    evaluation::Eval Search::quiescence(int plies_root, evaluation::Eval alpha, evaluation::Eval beta) noexcept {
+        assert(plies_root < game::MAX_PLY);
+
+        m_quiescence_nodes++;
+
+        count_node();
+
+        if (is_stopped()) {
+            return 0;
+        }
+
+        m_pv_size[plies_root] = 0;
+
+        const bool capture_moves {moves::has_capture_moves(m_position)};
+
+        if (!capture_moves && !moves::has_normal_moves(m_position)) {  // Game over
+            m_nodes_evaluated++;
+            return evaluation::MIN + plies_root;
+        }
+
+        if (game::is_forty_move_rule(m_position)) {  // Game over
+            m_nodes_evaluated++;
+            return 0;
+        }
+
+        if (is_threefold_repetition()) {  // Game over
+            m_nodes_evaluated++;
+            return 0;
+        }
+
+        // Stand pat only when no capture is forced, as a forced capture can't be declined
+        // Capture sequences are finite, but guard against running out of plies anyway
+        if (!capture_moves || plies_root == game::MAX_PLY - 1) {
+            m_nodes_evaluated++;
+            return evaluate() * evaluation::perspective(m_position);
+        }
+
+        // Only the captures are generated, and the TT is not used beyond the depth
+        move_picker::MovePicker picker {
+            m_position,
+            capture_moves,
+            pv_move(plies_root),
+            game::NULL_MOVE,
+            m_move_ordering,
+            plies_root,
+            m_moves_made[plies_root]
+        };
+
+        while (true) {
+            const game::Move move {picker.next()};
+
+            if (move == game::NULL_MOVE) {
+                break;
+            }
+
+            m_moves_made[plies_root + 1] = move;
+
+            game::MoveUndo undo;
+            make_move(move, undo);
+
+            const evaluation::Eval evaluation {-quiescence(plies_root + 1, -beta, -alpha)};
+
+            unmake_move(move, undo);
+
+            if (is_stopped()) {
+                return 0;
+            }
+
+            m_reached_left_most_path = true;
+
+            if (evaluation >= beta) {
+                return beta;
+            }
+
+            if (evaluation > alpha) {
+                alpha = evaluation;
+                update_pv(plies_root, move);
+            }
+        }
 
         return alpha;
     }
 
-    const game::SearchNode& Search::setup_nodes(
+    evaluation::Eval Search::search_younger_brother(
+        int depth,
+        int plies_root,
+        evaluation::Eval alpha,
+        evaluation::Eval beta,
+        NodeType node_type,
+        int reduction
+    ) noexcept {
+        // A late move is expected to fail low even at a reduced depth; only if it doesn't, it's searched again
+        if (reduction > 0) {
+            const evaluation::Eval evaluation {
+                -alpha_beta(depth - 1 - reduction, plies_root + 1, -alpha - 1, -alpha, NodeType::Cut)
+            };
+
+            if (evaluation <= alpha || is_stopped()) {
+                return evaluation;
+            }
+        }
+
+        // Every child but the first one is expected to be a CUT node
+        if (!m_parameters.pvs || node_type != NodeType::Pv || beta - alpha <= 1) {
+            return -alpha_beta(depth - 1, plies_root + 1, -beta, -alpha, NodeType::Cut);
+        }
+
+        // Try to prove that the move is not better than the PV move with a null window
+        const evaluation::Eval evaluation {-alpha_beta(depth - 1, plies_root + 1, -alpha - 1, -alpha, NodeType::Cut)};
+
+        if (evaluation <= alpha || evaluation >= beta || is_stopped()) {
+            return evaluation;
+        }
+
+        // It is better, so it is a new PV node and its exact evaluation is needed
+        return -alpha_beta(depth - 1, plies_root + 1, -beta, -alpha, NodeType::Pv);
+    }
+
+    int Search::late_move_reduction(int depth, int move_index, NodeType node_type, game::Move move, const game::MoveUndo& undo) const noexcept {
+        // Only quiet moves outside of PV nodes; crowning is not quiet
+        if (node_type == NodeType::Pv || game::is_move_capture(move) || undo.crowned) {
+            return 0;
+        }
+
+        assert(depth > 0 && depth <= game::MAX_DEPTH);
+
+        return m_reductions[depth][std::min(move_index, moves::MAX_MOVES - 1)];
+    }
+
+    evaluation::Eval Search::split(
+        move_picker::MovePicker& picker,
+        int depth,
+        int plies_root,
+        evaluation::Eval alpha,
+        evaluation::Eval beta,
+        NodeType node_type,
+        game::Move& best_move
+    ) noexcept {
+        moves::Moves moves;
+
+        while (true) {
+            const game::Move move {picker.next()};
+
+            if (move == game::NULL_MOVE) {
+                break;
+            }
+
+            if (is_excluded(plies_root, move)) {
+                continue;
+            }
+
+            moves.push_back(move);
+        }
+
+        if (moves.empty()) {
+            return alpha;
+        }
+
+        SplitPoint split_point;
+        split_point.parent = m_split_point;
+        split_point.owner = this;
+        split_point.position = m_position;
+        split_point.history = m_history;
+        split_point.depth = depth;
+        split_point.plies_root = plies_root;
+        split_point.node_type = node_type;
+        split_point.beta = beta;
+        split_point.alpha = alpha;
+        split_point.pending = moves.size();
+
+        // Push them in reverse, so that this thread takes them in order from the back, while thieves take the last ones
+        // The eldest brother is already searched
+        for (int i {moves.size() - 1}; i >= 0; i--) {
+            const game::Move move {moves[i]};
+            const int move_index {i + 1};
+            SplitPoint* split_point_pointer {&split_point};
+            Search* const* searches {m_searches};
+
+            m_pool->push(m_thread_index, {
+                [searches, split_point_pointer, move, move_index](int thread_index) {
+                    searches[thread_index]->search_split_move(*split_point_pointer, move, move_index);
+                },
+                split_point_pointer
+            });
+        }
+
+        // Help with the moves that are not yet stolen, then wait for the others
+        while (split_point.pending.load(std::memory_order_acquire) > 0) {
+            if (!m_pool->run_own(m_thread_index, &split_point)) {
+                if (m_thread_index == 0) {
+                    check_time(std::chrono::steady_clock::now());
+                }
+
+                std::this_thread::yield();
+            }
+        }
+
+        m_nodes_evaluated += split_point.nodes_evaluated;
+        m_quiescence_nodes += split_point.quiescence_nodes;
+        m_transpositions += split_point.transpositions;
+        m_cache_probes += split_point.cache_probes;
+        m_cache_hits += split_point.cache_hits;
+
+        best_move = split_point.best_move;
+
+        if (split_point.cutoff) {
+            return split_point.beta;
+        }
+
+        if (best_move != game::NULL_MOVE) {
+            m_pv_table[plies_root][0] = best_move;
+            std::memcpy(m_pv_table[plies_root] + 1, split_point.pv_moves, split_point.pv_size * sizeof(game::Move));
+            m_pv_size[plies_root] = split_point.pv_size + 1;
+        }
+
+        return split_point.alpha;
+    }
+
+    void Search::search_split_move(SplitPoint& split_point, game::Move move, int move_index) noexcept {
+        SplitPoint* previous_split_point {m_split_point};
+        m_split_point = &split_point;
+
+        // The owner is already at the split point
+        const bool owner {this == split_point.owner};
+
+        if (!owner) {
+            m_position = split_point.position;
+            m_history = split_point.history;
+            m_reached_left_most_path = true;
+        }
+
+        const int nodes_evaluated {m_nodes_evaluated};
+        const int quiescence_nodes {m_quiescence_nodes};
+        const int transpositions {m_transpositions};
+        const int cache_probes {m_cache_probes};
+        const int cache_hits {m_cache_hits};
+
+        if (!is_stopped()) {
+            const evaluation::Eval alpha {split_point.alpha.load(std::memory_order_relaxed)};
+
+            m_moves_made[split_point.plies_root + 1] = move;
+
+            game::MoveUndo undo;
+            make_move(move, undo);
+
+            const int reduction {late_move_reduction(split_point.depth, move_index, split_point.node_type, move, undo)};
+
+            const evaluation::Eval evaluation {
+                search_younger_brother(
+                    split_point.depth,
+                    split_point.plies_root,
+                    alpha,
+                    split_point.beta,
+                    split_point.node_type,
+                    reduction
+                )
+            };
+
+            unmake_move(move, undo);
+
+            if (!is_stopped()) {
+                std::lock_guard lock {split_point.mutex};
+
+                if (evaluation > split_point.alpha) {
+                    split_point.best_move = move;
+
+                    if (evaluation >= split_point.beta) {
+                        split_point.cutoff = true;
+                    } else {
+                        split_point.alpha = evaluation;
+
+                        const int plies_root {split_point.plies_root + 1};
+                        std::memcpy(split_point.pv_moves, m_pv_table[plies_root], m_pv_size[plies_root] * sizeof(game::Move));
+                        split_point.pv_size = m_pv_size[plies_root];
+                    }
+                }
+            }
+        }
+
+        // The owner counts its own nodes
+        if (!owner) {
+            std::lock_guard lock {split_point.mutex};
+            split_point.nodes_evaluated += m_nodes_evaluated - nodes_evaluated;
+            split_point.quiescence_nodes += m_quiescence_nodes - quiescence_nodes;
+            split_point.transpositions += m_transpositions - transpositions;
+            split_point.cache_probes += m_cache_probes - cache_probes;
+            split_point.cache_hits += m_cache_hits - cache_hits;
+        }
+
+        m_split_point = previous_split_point;
+
+        // This is the last access to the split point, as the owner may return right after
+        split_point.pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    void Search::setup_position(
         const game::GamePosition& position,
         const std::vector<game::GamePosition>& previous_positions,
         const std::vector<game::Move>& moves_played
@@ -259,37 +674,26 @@ namespace search {
             const game::Move move_played {moves_played.at(i)};
 
             if (game::is_move_advancement(previous_position.board, move_played)) {
-                // Clear any previous inserted nodes, as they don't need to be checked
-                m_nodes.clear();
+                // Clear any previous inserted positions, as they don't need to be checked
+                m_history.clear();
             } else {
-                m_nodes.push_back({
-                    previous_position.board,
-                    previous_position.player,
-                    previous_position.plies_without_advancement,
-                    previous_position.key,
-                    previous_position.signature,
-                    nullptr
-                });
+                m_history.push(previous_position.key, previous_position.signature);
             }
         }
 
-        m_nodes.push_back({
-            position.board,
-            position.player,
-            position.plies_without_advancement,
-            position.key,
-            position.signature,
-            nullptr
-        });
+        m_history.push(position.key, position.signature);
 
-        // Go backwards and link the nodes
-        for (int i {m_nodes.size() - 1}; i > 0; i--) {
-            m_nodes[i].previous = &m_nodes[i - 1];
-        }
+        m_position = position;
+        m_moves_made[0] = moves_played.empty() ? game::NULL_MOVE : moves_played.back();
+    }
 
-        assert(!m_nodes.empty());
+    void Search::enable_split(thread_pool::ThreadPool* pool, Search* const* searches) noexcept {
+        m_pool = pool;
+        m_searches = searches;
+    }
 
-        return m_nodes.back();
+    void Search::enable_evaluation_cache(evaluation_cache::EvaluationCache* evaluation_cache) noexcept {
+        m_evaluation_cache = evaluation_cache;
     }
 
     void Search::setup_parameters(const parameters::Parameters& parameters) noexcept {
@@ -300,58 +704,150 @@ namespace search {
         m_parameters.positioning_pawn = std::get<0>(parameters.at("positioning_pawn"));
         m_parameters.positioning_king = std::get<0>(parameters.at("positioning_king"));
         m_parameters.crowdness = std::get<0>(parameters.at("crowdness"));
+        m_parameters.pvs = std::get<2>(parameters.at("pvs"));
+        m_parameters.lmr = std::get<2>(parameters.at("lmr"));
+        m_parameters.lmr_depth = std::get<0>(parameters.at("lmr_depth"));
+        m_parameters.lmr_moves = std::get<0>(parameters.at("lmr_moves"));
+        m_parameters.lmr_base = std::get<1>(parameters.at("lmr_base"));
+        m_parameters.lmr_div = std::get<1>(parameters.at("lmr_div"));
+        m_parameters.multipv = std::get<0>(parameters.at("multipv"));
+
+        setup_reductions();
     }
 
-    void Search::fill_pv(game::PvLine& p_line, const game::PvLine& line, game::Move move) noexcept {
-        p_line.moves[0] = move;
-        std::memcpy(p_line.moves + 1, line.moves, line.size * sizeof(move));
-        p_line.size = line.size + 1;
+    void Search::setup_reductions() noexcept {
+        if (!m_parameters.lmr || m_parameters.lmr_div <= 0.0f) {
+            return;
+        }
+
+        // Reduce more the deeper the node and the later the move
+        for (int depth {std::max(m_parameters.lmr_depth, 1)}; depth <= game::MAX_DEPTH; depth++) {
+            for (int move_index {std::max(m_parameters.lmr_moves, 1)}; move_index < moves::MAX_MOVES; move_index++) {
+                const float reduction {
+                    m_parameters.lmr_base + std::log(static_cast<float>(depth)) * std::log(static_cast<float>(move_index)) / m_parameters.lmr_div
+                };
+
+                // Always leave at least one ply to search
+                m_reductions[depth][move_index] = std::clamp(static_cast<int>(reduction), 0, std::max(depth - 2, 0));
+            }
+        }
     }
 
-    void Search::reorder_moves_pv(moves::Moves& moves, const game::PvLine& pv, int plies_root) const noexcept {
-        if ((plies_root >= pv.size) | m_reached_left_most_path) {
-            return;
+    void Search::make_move(game::Move move, game::MoveUndo& undo) noexcept {
+        game::make_move(m_position, move, undo);
+        m_history.push(m_position.key, m_position.signature);
+    }
+
+    void Search::unmake_move(game::Move move, const game::MoveUndo& undo) noexcept {
+        m_history.pop();
+        game::unmake_move(m_position, move, undo);
+    }
+
+    bool Search::is_threefold_repetition() const noexcept {
+        return m_history.is_threefold_repetition(m_position.plies_without_advancement);
+    }
+
+    void Search::update_pv(int plies_root, game::Move move) noexcept {
+        m_pv_table[plies_root][0] = move;
+        std::memcpy(m_pv_table[plies_root] + 1, m_pv_table[plies_root + 1], m_pv_size[plies_root + 1] * sizeof(move));
+        m_pv_size[plies_root] = m_pv_size[plies_root + 1] + 1;
+    }
+
+    game::Move Search::pv_move(int plies_root) const noexcept {
+        const game::PvLine& pv_line {m_root_lines[m_pv_index].pv};
+
+        if ((plies_root >= pv_line.size) | m_reached_left_most_path) {
+            return game::NULL_MOVE;
+        }
+
+        return pv_line.moves[plies_root];
+    }
+
+    evaluation::Eval Search::static_evaluation() const noexcept {
+#ifdef FROZEN_EVALUATION
+        return evaluation::static_evaluation<frozen_parameters::FROZEN_EVALUATION>(m_position);
+#else
+        return evaluation::static_evaluation(m_position, m_parameters);
+#endif
+    }
+
+    evaluation::Eval Search::evaluate() noexcept {
+        if (m_evaluation_cache == nullptr) {
+            return static_evaluation();
         }
 
-        const auto iter {std::find(moves.begin(), moves.end(), pv.moves[plies_root])};
+        m_cache_probes++;
+
+        evaluation::Eval eval {};
+
+        if (m_evaluation_cache->load(m_position.key, eval)) {
+            m_cache_hits++;
+            return eval;
+        }
 
-        assert(iter != moves.end());
+        eval = static_evaluation();
+        m_evaluation_cache->store(m_position.key, eval);
 
-        // Place the PV move first
-        std::iter_swap(moves.begin(), iter);
+        return eval;
     }
 
-    void Search::reorder_moves_hash_move(moves::Moves& moves, game::Move hash_move) noexcept {
-        if (hash_move == game::NULL_MOVE) {
+    void Search::store_transposition(
+        int plies_root,
+        int depth,
+        transposition_table::Flag flag,
+        evaluation::Eval evaluation,
+        game::Move move
+    ) noexcept {
+        // With root moves excluded, the result is not the root's real one
+        if (plies_root == 0 && !m_excluded_moves.empty()) {
             return;
         }
 
-        const auto iter {std::find(moves.begin(), moves.end(), hash_move)};
+        m_transposition_table.store(m_position.key, depth, m_search_sequence, flag, evaluation, move);
+    }
 
-        assert(iter != moves.end());
+    bool Search::is_excluded(int plies_root, game::Move move) const noexcept {
+        if (plies_root > 0) {
+            return false;
+        }
 
-        // If the hash move is already the PV move, don't touch it (or there is only one move in the array)
-        if (iter == moves.begin()) {
-            return;
+        for (int i {0}; i < m_excluded_moves.size(); i++) {
+            if (m_excluded_moves[i] == move) {
+                return true;
+            }
         }
 
-        // Place the hash move second (first is PV move)
-        std::iter_swap(std::next(moves.begin()), iter);
+        return false;
     }
 
     void Search::reset_after_search_iteration() noexcept {
         m_reached_left_most_path = false;
         m_nodes_evaluated = 0;
+        m_quiescence_nodes = 0;
         m_transpositions = 0;
+        m_cache_probes = 0;
+        m_cache_hits = 0;
     }
 
-    void Search::check_max_time(TimePoint time_point) noexcept {
-        if (std::chrono::duration<double>(time_point - m_begin_search).count() > m_max_time) {
-            m_should_stop = true;
+    void Search::check_time(time_manager::TimePoint time_point) noexcept {
+        // The time spent pondering is free
+        if (m_pondering && !m_ponder.load(std::memory_order_relaxed)) {
+            m_pondering = false;
+            m_time_manager.start(m_limits, time_point);
+        }
+
+        if (m_time_manager.is_hard_limit_reached(time_point)) {
+            m_should_stop.store(true, std::memory_order_relaxed);
         }
     }
 
     evaluation::Eval Search::window_delta() const noexcept {
-        return (m_parameters.material_pawn * 80) / 100;
+#ifdef FROZEN_EVALUATION
+        const parameters::Int material_pawn {frozen_parameters::FROZEN_EVALUATION::material_pawn};
+#else
+        const parameters::Int material_pawn {m_parameters.material_pawn};
+#endif
+
+        return (material_pawn * 80) / 100;
     }
 }
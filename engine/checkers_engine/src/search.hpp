@@ -2,21 +2,44 @@
 
 #include <vector>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
 
 #include "game.hpp"
+#include "array.hpp"
 #include "evaluation.hpp"
 #include "parameters.hpp"
 #include "transposition_table.hpp"
+#include "evaluation_cache.hpp"
+#include "repetition.hpp"
 #include "moves.hpp"
-#include "array.hpp"
+#include "move_picker.hpp"
+#include "move_ordering.hpp"
+#include "thread_pool.hpp"
+#include "time_manager.hpp"
 
 namespace search {
+    // Expected node types, as classified by Knuth and Moore
+    enum class NodeType {
+        Pv,
+        Cut,
+        All
+    };
+
+    // The most lines reported by a multi-PV search
+    inline constexpr int MAX_MULTIPV {16};
+
     class Search {
     public:
+        // Thread 0 is the main search; the others are helpers that only fill the shared TT
         Search(
             int search_sequence,
             const parameters::Parameters& parameters,
-            transposition_table::TranspositionTable& transposition_table
+            transposition_table::TranspositionTable& transposition_table,
+            std::atomic_bool& should_stop,
+            const std::atomic_bool& ponder,
+            int thread_index = 0
         ) noexcept;
 
         game::Move search(
@@ -24,57 +47,218 @@ namespace search {
             const std::vector<game::GamePosition>& previous_positions,
             const std::vector<game::Move>& moves_played,
             int max_depth,
-            double max_time
+            const time_manager::Limits& limits
         ) noexcept;
 
-        bool* get_should_stop() noexcept { return &m_should_stop; }
+        // The expected reply of the opponent to the best move, if any
+        game::Move ponder_move() const noexcept {
+            const game::PvLine& best_line {m_root_lines[0].pv};
+
+            return best_line.size > 1 ? best_line.moves[1] : game::NULL_MOVE;
+        }
+
+        // Young Brothers Wait; the searches of all threads, indexed by the thread index, must stay alive
+        void enable_split(thread_pool::ThreadPool* pool, Search* const* searches) noexcept;
+
+        // The cache must be used by this search only and stay alive
+        void enable_evaluation_cache(evaluation_cache::EvaluationCache* evaluation_cache) noexcept;
     private:
-        using TimePoint = std::chrono::steady_clock::time_point;
+        // A best line of the root, the window for searching it again and its statistics
+        struct RootLine {
+            game::PvLine pv;
+            evaluation::Eval alpha {evaluation::WINDOW_MIN};
+            evaluation::Eval beta {evaluation::WINDOW_MAX};
+            evaluation::Eval evaluation {};
+            double time {};
+            int nodes_evaluated {};
+            int quiescence_nodes {};
+            int transpositions {};
+            int cache_hits {};  // Permille, or negative without a cache
+        };
+
+        // A node whose remaining moves are searched in parallel by any thread
+        struct SplitPoint {
+            const SplitPoint* parent {nullptr};
+            const Search* owner {nullptr};
+            game::GamePosition position;
+            repetition::History history;
+            int depth {};
+            int plies_root {};
+            NodeType node_type {};
+            evaluation::Eval beta {};
+
+            // Results; written under the lock
+            std::mutex mutex;
+            std::atomic<evaluation::Eval> alpha {};
+            game::Move best_move {game::NULL_MOVE};
+            game::Move pv_moves[game::MAX_PLY] {};  // The line after the best move
+            int pv_size {0};
+            int nodes_evaluated {0};
+            int quiescence_nodes {0};
+            int transpositions {0};
+            int cache_probes {0};
+            int cache_hits {0};
+
+            std::atomic_bool cutoff {false};
+            std::atomic_int pending {0};  // Tasks not yet finished
+
+            // A cutoff aborts every thread working below it
+            bool is_aborted() const noexcept {
+                for (const SplitPoint* split_point {this}; split_point != nullptr; split_point = split_point->parent) {
+                    if (split_point->cutoff.load(std::memory_order_relaxed)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+        };
 
         // Return positive if the side to move is doing better and negative if the opposite side is doing better
-        evaluation::Eval alpha_beta(
+        evaluation::Eval alpha_beta(int depth, int plies_root, evaluation::Eval alpha, evaluation::Eval beta, NodeType node_type) noexcept;
+
+        // Resolve the forced captures beyond the depth of the search
+        evaluation::Eval quiescence(int plies_root, evaluation::Eval alpha, evaluation::Eval beta) noexcept;
+
+        // Search any move but the first one of a node, after it is made; return the evaluation from the node's perspective
+        evaluation::Eval search_younger_brother(
             int depth,
             int plies_root,
             evaluation::Eval alpha,
             evaluation::Eval beta,
-            const game::SearchNode& current_node,
-            game::PvLine& p_line,
-            const game::PvLine& pv
+            NodeType node_type,
+            int reduction
         ) noexcept;
 
-        const game::SearchNode& setup_nodes(
+        int late_move_reduction(int depth, int move_index, NodeType node_type, game::Move move, const game::MoveUndo& undo) const noexcept;
+
+        // Search the rest of the moves in parallel; return the new alpha or an evaluation over beta
+        evaluation::Eval split(
+            move_picker::MovePicker& picker,
+            int depth,
+            int plies_root,
+            evaluation::Eval alpha,
+            evaluation::Eval beta,
+            NodeType node_type,
+            game::Move& best_move
+        ) noexcept;
+
+        void search_split_move(SplitPoint& split_point, game::Move move, int move_index) noexcept;
+
+        void setup_position(
             const game::GamePosition& position,
             const std::vector<game::GamePosition>& previous_positions,
             const std::vector<game::Move>& moves_played
         ) noexcept;
 
         void setup_parameters(const parameters::Parameters& parameters) noexcept;
-        static void fill_pv(game::PvLine& p_line, const game::PvLine& line, game::Move move) noexcept;
-        void reorder_moves_pv(moves::Moves& moves, const game::PvLine& pv, int plies_root) const noexcept;
-        static void reorder_moves_hash_move(moves::Moves& moves, game::Move hash_move) noexcept;
+        void setup_reductions() noexcept;
+        void make_move(game::Move move, game::MoveUndo& undo) noexcept;
+        void unmake_move(game::Move move, const game::MoveUndo& undo) noexcept;
+        bool is_threefold_repetition() const noexcept;
+        void update_pv(int plies_root, game::Move move) noexcept;
+        game::Move pv_move(int plies_root) const noexcept;
+        bool is_excluded(int plies_root, game::Move move) const noexcept;
+
+        void store_transposition(
+            int plies_root,
+            int depth,
+            transposition_table::Flag flag,
+            evaluation::Eval evaluation,
+            game::Move move
+        ) noexcept;
         void reset_after_search_iteration() noexcept;
-        void check_max_time(TimePoint time_point) noexcept;
+        void check_time(time_manager::TimePoint time_point) noexcept;
         evaluation::Eval window_delta() const noexcept;
+        evaluation::Eval static_evaluation() const noexcept;
+        evaluation::Eval evaluate() noexcept;
+
+        // Every node of the main search counts towards the node limit, if any
+        void count_node() noexcept {
+            m_nodes++;
+
+            // Check the time every now and then
+            if (m_nodes % 70'000 == 0) {
+                check_time(std::chrono::steady_clock::now());
+            }
+
+            if (m_limits.nodes && m_nodes >= *m_limits.nodes && m_thread_index == 0 && !m_pondering) {
+                m_should_stop.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        bool is_stopped() const noexcept {
+            if (m_should_stop.load(std::memory_order_relaxed) & m_can_stop) {
+                return true;
+            }
+
+            return m_split_point != nullptr && m_split_point->is_aborted();
+        }
+
+        // Shared by all threads of the search
+        std::atomic_bool& m_should_stop;
+
+        // Set while searching on the opponent's time; cleared on ponder hit, when the limits come into effect
+        const std::atomic_bool& m_ponder;
+        bool m_pondering {false};
 
-        bool m_should_stop {false};
         bool m_can_stop {false};
         bool m_reached_left_most_path {false};
         int m_nodes_evaluated {0};
+        int m_quiescence_nodes {0};
         int m_transpositions {0};
+        int m_cache_probes {0};
+        int m_cache_hits {0};
+
+        // All the nodes of the search, not reset between iterations
+        std::int64_t m_nodes {0};
 
         // The number of this particular search
         int m_search_sequence {};
 
+        int m_thread_index {};
+
         parameters::SearchParameters m_parameters;
 
-        // Used to check for max time
-        double m_max_time {};
-        TimePoint m_begin_search {};
+        // Late move reductions by depth and move index
+        int m_reductions[game::MAX_DEPTH + 1][moves::MAX_MOVES] {};
+
+        time_manager::TimeManager m_time_manager;
+        time_manager::Limits m_limits;
+
+        // The position on which the moves are made and unmade
+        game::GamePosition m_position;
 
         // The current and previous positions (for threefold repetition)
-        // node0, node1, node2, ..., nodeN (current)
-        array::Array<game::SearchNode, 81> m_nodes;
+        repetition::History m_history;
+
+        // Triangular PV table; every ply builds its line from the line of the next ply
+        game::Move m_pv_table[game::MAX_PLY][game::MAX_PLY] {};
+        int m_pv_size[game::MAX_PLY] {};
+
+        // The PVs of the last iteration, used for move ordering; the first line is the best one
+        RootLine m_root_lines[MAX_MULTIPV];
+        int m_pv_index {0};
+
+        // The root moves of the better lines of the current iteration
+        array::Array<game::Move, MAX_MULTIPV> m_excluded_moves;
+
+        // Killers, history and counter moves of this thread
+        move_ordering::MoveOrdering m_move_ordering;
+
+        // The move leading to every ply; the first one is the last move played in the game
+        game::Move m_moves_made[game::MAX_PLY + 1] {};
 
         transposition_table::TranspositionTable& m_transposition_table;
+
+        // Null, if there is no evaluation cache
+        evaluation_cache::EvaluationCache* m_evaluation_cache {nullptr};
+
+        // Null, if the search is not split
+        thread_pool::ThreadPool* m_pool {nullptr};
+        Search* const* m_searches {nullptr};
+
+        // The split point of the move this thread is searching, if any
+        SplitPoint* m_split_point {nullptr};
     };
 }
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+
+#include "game.hpp"
+#include "bitboard.hpp"
+
+// Tables of neighbor squares, computed at compile time
+
+namespace tables {
+    struct Jump {
+        int over {game::NULL_INDEX};  // The square of the jumped piece
+        int landing {game::NULL_INDEX};
+    };
+
+    using StepTable = std::array<std::array<int, 4>, 32>;
+    using JumpTable = std::array<std::array<Jump, 4>, 32>;
+
+    constexpr int step(int square_index, bitboard::Direction direction) noexcept {
+        const bool even_row {(square_index / 4) % 2 == 0};
+
+        int result_index {square_index};
+
+        switch (direction) {
+            case bitboard::Direction::NorthEast:
+                result_index -= even_row ? 3 : 4;
+                break;
+            case bitboard::Direction::NorthWest:
+                result_index -= even_row ? 4 : 5;
+                break;
+            case bitboard::Direction::SouthEast:
+                result_index += even_row ? 5 : 4;
+                break;
+            case bitboard::Direction::SouthWest:
+                result_index += even_row ? 4 : 3;
+                break;
+        }
+
+        // Check out of bounds
+        if (result_index < 0 || result_index > 31) {
+            return game::NULL_INDEX;
+        }
+
+        // Check edge cases (literally)
+        if (square_index / 4 - result_index / 4 != 1 && result_index / 4 - square_index / 4 != 1) {
+            return game::NULL_INDEX;
+        }
+
+        return result_index;
+    }
+
+    constexpr StepTable generate_step_table() noexcept {
+        StepTable result {};
+
+        for (int i {0}; i < 32; i++) {
+            for (int d {0}; d < 4; d++) {
+                result[i][d] = step(i, static_cast<bitboard::Direction>(d));
+            }
+        }
+
+        return result;
+    }
+
+    constexpr JumpTable generate_jump_table() noexcept {
+        JumpTable result {};
+
+        for (int i {0}; i < 32; i++) {
+            for (int d {0}; d < 4; d++) {
+                const int over {step(i, static_cast<bitboard::Direction>(d))};
+
+                if (over == game::NULL_INDEX) {
+                    continue;
+                }
+
+                const int landing {step(over, static_cast<bitboard::Direction>(d))};
+
+                if (landing == game::NULL_INDEX) {
+                    continue;
+                }
+
+                result[i][d] = {over, landing};
+            }
+        }
+
+        return result;
+    }
+
+    constexpr std::array<bitboard::Bitboard, 32> generate_neighbors_table() noexcept {
+        std::array<bitboard::Bitboard, 32> result {};
+
+        for (int i {0}; i < 32; i++) {
+            for (int d {0}; d < 4; d++) {
+                const int neighbor {step(i, static_cast<bitboard::Direction>(d))};
+
+                if (neighbor != game::NULL_INDEX) {
+                    result[i] |= bitboard::bit(neighbor);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // Neighbor square in every direction, or null index if it's off the board
+    inline constexpr StepTable STEP {generate_step_table()};
+
+    // All the neighbor squares
+    inline constexpr std::array<bitboard::Bitboard, 32> NEIGHBORS {generate_neighbors_table()};
+
+    // Jumped square and landing square in every direction, both null, if the jump is off the board
+    inline constexpr JumpTable JUMP {generate_jump_table()};
+
+    template<bitboard::Direction Dir>
+    constexpr int step(int square_index) noexcept {
+        return STEP[square_index][static_cast<int>(Dir)];
+    }
+
+    template<bitboard::Direction Dir>
+    constexpr Jump jump(int square_index) noexcept {
+        return JUMP[square_index][static_cast<int>(Dir)];
+    }
+}
@@ -0,0 +1,119 @@
+#include "thread_pool.hpp"
+
+#include <utility>
+#include <cassert>
+
+namespace thread_pool {
+    ThreadPool::~ThreadPool() noexcept {
+        stop();
+    }
+
+    void ThreadPool::start(int threads) {
+        assert(threads >= 1);
+        assert(m_pending == 0);
+
+        stop();
+
+        for (int i {0}; i < threads; i++) {
+            m_queues.push_back(std::make_unique<Queue>());
+        }
+
+        m_running = true;
+
+        for (int i {1}; i < threads; i++) {
+            m_threads.emplace_back([this, i]() {
+                worker(i);
+            });
+        }
+    }
+
+    void ThreadPool::stop() noexcept {
+        {
+            std::lock_guard lock {m_mutex};
+            m_running = false;
+        }
+        m_cv.notify_all();
+
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+
+        m_threads.clear();
+        m_queues.clear();
+    }
+
+    void ThreadPool::push(int thread_index, Task&& task) {
+        {
+            Queue& queue {*m_queues[thread_index]};
+            std::lock_guard lock {queue.mutex};
+            queue.tasks.push_back(std::move(task));
+        }
+
+        // Increment under the lock, so that a worker doesn't miss it right before going to sleep
+        {
+            std::lock_guard lock {m_mutex};
+            m_pending++;
+        }
+        m_cv.notify_one();
+    }
+
+    bool ThreadPool::run_own(int thread_index, const void* group) {
+        Task task;
+
+        {
+            Queue& queue {*m_queues[thread_index]};
+            std::lock_guard lock {queue.mutex};
+
+            if (queue.tasks.empty() || queue.tasks.back().group != group) {
+                return false;
+            }
+
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+
+        m_pending--;
+        task.function(thread_index);
+
+        return true;
+    }
+
+    void ThreadPool::worker(int thread_index) {
+        while (true) {
+            Task task;
+
+            if (steal(thread_index, task)) {
+                task.function(thread_index);
+                continue;
+            }
+
+            std::unique_lock lock {m_mutex};
+            m_cv.wait(lock, [this]() { return m_pending > 0 || !m_running; });
+
+            if (!m_running) {
+                break;
+            }
+        }
+    }
+
+    bool ThreadPool::steal(int thread_index, Task& task) {
+        // Workers don't keep tasks of their own when they are idle, so look only at the others
+        for (int i {1}; i < size(); i++) {
+            Queue& queue {*m_queues[(thread_index + i) % size()]};
+            std::lock_guard lock {queue.mutex};
+
+            if (queue.tasks.empty()) {
+                continue;
+            }
+
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+
+            m_pending--;
+
+            return true;
+        }
+
+        return false;
+    }
+}
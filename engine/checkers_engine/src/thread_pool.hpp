@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+
+// https://en.wikipedia.org/wiki/Work_stealing
+
+namespace thread_pool {
+    struct Task {
+        std::function<void(int)> function;  // Receives the index of the thread that runs it
+        const void* group {nullptr};  // Tasks are tagged, so that a thread can wait for its own tasks
+    };
+
+    // Thread 0 is the thread that owns the pool and the others are the workers
+    // Every thread has its own deque; a thread takes its own tasks from the back and steals from the front of others
+    class ThreadPool {
+    public:
+        ThreadPool() noexcept = default;
+        ~ThreadPool() noexcept;
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        // Must not be called while there are tasks
+        void start(int threads);
+        void stop() noexcept;
+
+        // Push a task into the deque of that thread
+        void push(int thread_index, Task&& task);
+
+        // Run the most recent task of the group from the deque of that thread; return false, if there is none
+        bool run_own(int thread_index, const void* group);
+
+        // Including thread 0
+        int size() const noexcept {
+            return static_cast<int>(m_queues.size());
+        }
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void worker(int thread_index);
+        bool steal(int thread_index, Task& task);
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        // Workers sleep while there are no tasks in any deque
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::atomic_int m_pending {0};
+        bool m_running {false};
+    };
+}
@@ -0,0 +1,103 @@
+#include "time_manager.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace time_manager {
+    // Keep some time for the communication with the GUI
+    static constexpr double MOVE_OVERHEAD {0.05};
+
+    // The number of moves to plan for, when the clock doesn't tell
+    static constexpr int DEFAULT_MOVES_TO_GO {30};
+
+    // Never plan for more moves than this, as it would make the soft target too small
+    static constexpr int MAX_MOVES_TO_GO {50};
+
+    // Part of the increment used on top of the share of the remaining time
+    static constexpr double INCREMENT_RATIO {0.75};
+
+    // The hard cap may be this many times over the soft target
+    static constexpr double HARD_RATIO {4.0};
+
+    // Never use more than this part of the remaining time on a single move
+    static constexpr double MAX_TIME_RATIO {0.8};
+
+    // After this many iterations with the same best move, half of the soft target is enough
+    static constexpr int STABLE_ITERATIONS {4};
+    static constexpr double STABLE_RATIO {0.5};
+
+    // Bounds of the branching factor used to predict the time of the next iteration
+    static constexpr double MIN_BRANCHING_FACTOR {1.5};
+    static constexpr double MAX_BRANCHING_FACTOR {8.0};
+
+    void TimeManager::start(const Limits& limits, TimePoint begin) noexcept {
+        m_begin = begin;
+        m_soft = 0.0;
+        m_hard = 0.0;
+        m_limited = limits.max_time || limits.clock;
+        m_clock = limits.clock.has_value();
+        m_best_move = game::NULL_MOVE;
+        m_stable_iterations = 0;
+        m_last_iteration_time = 0.0;
+
+        if (limits.clock) {
+            const Clock& clock {*limits.clock};
+
+            const double available {std::max(clock.time - MOVE_OVERHEAD, 0.0)};
+            const int moves_to_go {clock.moves_to_go > 0 ? std::min(clock.moves_to_go, MAX_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO};
+            const double increment {std::max(clock.increment, 0.0)};
+
+            m_soft = std::min(available / moves_to_go + increment * INCREMENT_RATIO, available * MAX_TIME_RATIO);
+            m_hard = std::min(m_soft * HARD_RATIO, available * MAX_TIME_RATIO);
+        }
+
+        if (limits.max_time) {
+            // It's a constraint over the clock
+            m_soft = m_clock ? std::min(m_soft, *limits.max_time) : *limits.max_time;
+            m_hard = m_clock ? std::min(m_hard, *limits.max_time) : *limits.max_time;
+        }
+
+        assert(m_soft <= m_hard);
+    }
+
+    bool TimeManager::is_hard_limit_reached(TimePoint time_point) const noexcept {
+        return m_limited && elapsed(time_point) > m_hard;
+    }
+
+    bool TimeManager::should_stop(game::Move best_move, double iteration_time, TimePoint time_point) noexcept {
+        if (best_move == m_best_move) {
+            m_stable_iterations++;
+        } else {
+            m_best_move = best_move;
+            m_stable_iterations = 0;
+        }
+
+        double branching_factor {MAX_BRANCHING_FACTOR};
+
+        if (m_last_iteration_time > 0.0) {
+            branching_factor = std::clamp(iteration_time / m_last_iteration_time, MIN_BRANCHING_FACTOR, MAX_BRANCHING_FACTOR);
+        }
+
+        m_last_iteration_time = iteration_time;
+
+        if (!m_limited) {
+            return false;
+        }
+
+        const double elapsed_time {elapsed(time_point)};
+
+        // Save time on a stable best move only with a game clock, as a fixed time per move is meant to be used
+        const double soft {m_clock && m_stable_iterations >= STABLE_ITERATIONS ? m_soft * STABLE_RATIO : m_soft};
+
+        if (elapsed_time >= soft) {
+            return true;
+        }
+
+        // Don't start an iteration that would only be thrown away at the hard cap
+        return elapsed_time + iteration_time * branching_factor > m_hard;
+    }
+
+    double TimeManager::elapsed(TimePoint time_point) const noexcept {
+        return std::chrono::duration<double>(time_point - m_begin).count();
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <cstdint>
+
+#include "game.hpp"
+
+// https://www.chessprogramming.org/Time_Management
+
+namespace time_manager {
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    // The game clock of the player to move; times are in seconds
+    struct Clock {
+        double time {};
+        double increment {};
+        int moves_to_go {};  // Zero, if unknown
+    };
+
+    // The constraints of a search, as given by GO; none means unconstrained
+    struct Limits {
+        std::optional<double> max_time;
+        std::optional<Clock> clock;
+        std::optional<std::int64_t> nodes;  // Not managed here, but by the search itself
+    };
+
+    // Decides how long the search can think
+    // The soft target is checked between iterations and the hard cap all the time
+    class TimeManager {
+    public:
+        void start(const Limits& limits, TimePoint begin) noexcept;
+
+        // Without any limit, the search stops only by depth or when told
+        bool is_limited() const noexcept {
+            return m_limited;
+        }
+
+        bool is_hard_limit_reached(TimePoint time_point) const noexcept;
+
+        // Called after every complete iteration; check if another one is worth starting
+        bool should_stop(game::Move best_move, double iteration_time, TimePoint time_point) noexcept;
+    private:
+        double elapsed(TimePoint time_point) const noexcept;
+
+        TimePoint m_begin {};
+        double m_soft {};
+        double m_hard {};
+        bool m_limited {false};
+        bool m_clock {false};
+
+        game::Move m_best_move {};
+        int m_stable_iterations {0};
+        double m_last_iteration_time {0.0};
+    };
+}
@@ -1,76 +1,361 @@
 #include "transposition_table.hpp"
 
+#include <limits>
+#include <algorithm>
 #include <cassert>
 
 #include "zobrist.hpp"
+#include "tables.hpp"
 
 namespace transposition_table {
+    // Moves are stored as the source square and the directions of the steps
+    // type (1 bit), source index (5 bits), number of steps (4 bits), direction of every step (2 bits each)
+
+    static std::uint32_t compact_move(game::Move move) noexcept {
+        if (move == game::NULL_MOVE) {
+            return 0;
+        }
+
+        const bool capture {game::is_move_capture(move)};
+
+        std::uint32_t result {0};
+        result |= static_cast<std::uint32_t>(move.type());
+        result |= static_cast<std::uint32_t>(move.source_index()) << 1;
+        result |= static_cast<std::uint32_t>(move.destination_indices_size()) << 6;
+
+        int square_index {move.source_index()};
+
+        for (int i {0}; i < move.destination_indices_size(); i++) {
+            const int destination_index {move.destination_index(i)};
+
+            for (int direction {0}; direction < 4; direction++) {
+                const int index {
+                    capture ? tables::JUMP[square_index][direction].landing : tables::STEP[square_index][direction]
+                };
+
+                if (index == destination_index) {
+                    result |= static_cast<std::uint32_t>(direction) << (i * 2 + 10);
+                    break;
+                }
+            }
+
+            square_index = destination_index;
+        }
+
+        return result;
+    }
+
+    static game::Move expand_move(std::uint32_t move) noexcept {
+        // The move may come from a key collision, so it may not even be on the board
+
+        const auto type {static_cast<game::MoveType>(move & 1u)};
+        const int source_index {static_cast<int>(move >> 1 & 0b11111u)};
+        const int size {static_cast<int>(move >> 6 & 0b1111u)};
+
+        if (size == 0) {
+            return game::NULL_MOVE;
+        }
+
+        if (type == game::MoveType::Normal) {
+            const int destination_index {tables::STEP[source_index][move >> 10 & 0b11u]};
+
+            if (size != 1 || destination_index == game::NULL_INDEX) {
+                return game::NULL_MOVE;
+            }
+
+            return game::Move(source_index, destination_index);
+        }
+
+        game::Move::DestinationIndices destination_indices {};
+
+        if (size > static_cast<int>(destination_indices.size())) {
+            return game::NULL_MOVE;
+        }
+
+        int square_index {source_index};
+
+        for (int i {0}; i < size; i++) {
+            const int destination_index {tables::JUMP[square_index][move >> (i * 2 + 10) & 0b11u].landing};
+
+            if (destination_index == game::NULL_INDEX) {
+                return game::NULL_MOVE;
+            }
+
+            destination_indices[i] = destination_index;
+            square_index = destination_index;
+        }
+
+        return game::Move(source_index, destination_indices, size);
+    }
+
+    // Normal evaluations are stored as they are; win and loss evaluations are stored relative to max and min
+    static constexpr int EVAL_NORMAL {30'000};
+    static constexpr int EVAL_WIN {32'000};
+    static constexpr int EVAL_WIN_RANGE {700};
+
+    static bool compact_eval(evaluation::Eval eval, std::int16_t& result) noexcept {
+        if (eval >= -EVAL_NORMAL && eval <= EVAL_NORMAL) {
+            result = static_cast<std::int16_t>(eval);
+            return true;
+        }
+
+        if (eval >= evaluation::MAX - EVAL_WIN_RANGE && eval <= evaluation::MAX + EVAL_WIN_RANGE) {
+            result = static_cast<std::int16_t>(EVAL_WIN + (eval - evaluation::MAX));
+            return true;
+        }
+
+        if (eval >= evaluation::MIN - EVAL_WIN_RANGE && eval <= evaluation::MIN + EVAL_WIN_RANGE) {
+            result = static_cast<std::int16_t>(-EVAL_WIN + (eval - evaluation::MIN));
+            return true;
+        }
+
+        // Window bounds don't fit
+        return false;
+    }
+
+    static evaluation::Eval expand_eval(std::int16_t eval) noexcept {
+        if (eval >= EVAL_WIN - EVAL_WIN_RANGE) {
+            return evaluation::MAX + (eval - EVAL_WIN);
+        }
+
+        if (eval <= -EVAL_WIN + EVAL_WIN_RANGE) {
+            return evaluation::MIN + (eval + EVAL_WIN);
+        }
+
+        return eval;
+    }
+
+    static_assert(EVAL_NORMAL < EVAL_WIN - EVAL_WIN_RANGE);
+    static_assert(EVAL_WIN + EVAL_WIN_RANGE <= std::numeric_limits<std::int16_t>::max());
+
+    // The eval takes the first 16 bits, the depth the next 8 bits, the bound the next 2 bits
+    // and the generation the last 6 bits
+    static constexpr int GENERATIONS {64};
+
+    // How many plies of depth is an entry from one search ago worth
+    static constexpr int AGE_WEIGHT {8};
+
+    // Single-threaded, these are plain loads and stores
+    static constexpr auto ORDER {std::memory_order_relaxed};
+
+    static constexpr std::uint32_t key_check(Key key) noexcept {
+        return static_cast<std::uint32_t>(key >> 32);
+    }
+
+    static constexpr std::uint32_t entry_check(Key key, std::uint32_t move, std::uint32_t data) noexcept {
+        return key_check(key) ^ move ^ data;
+    }
+
+    static constexpr std::uint32_t pack_data(std::int16_t eval, int depth, Flag flag, int generation) noexcept {
+        return
+            static_cast<std::uint16_t>(eval) |
+            static_cast<std::uint32_t>(static_cast<std::uint8_t>(depth)) << 16 |
+            static_cast<std::uint32_t>(static_cast<int>(flag) + 1) << 24 |
+            static_cast<std::uint32_t>(generation) << 26;
+    }
+
+    static constexpr bool is_empty(std::uint32_t data) noexcept {
+        return (data >> 24 & 0b11u) == 0;
+    }
+
+    static constexpr std::int16_t entry_eval(std::uint32_t data) noexcept {
+        return static_cast<std::int16_t>(data & 0xFFFFu);
+    }
+
+    static constexpr int entry_depth(std::uint32_t data) noexcept {
+        return static_cast<std::int8_t>(data >> 16 & 0xFFu);
+    }
+
+    static constexpr Flag entry_flag(std::uint32_t data) noexcept {
+        return static_cast<Flag>((data >> 24 & 0b11u) - 1);
+    }
+
+    static constexpr int entry_generation(std::uint32_t data) noexcept {
+        return static_cast<int>(data >> 26);
+    }
+
+    static constexpr int entry_age(std::uint32_t data, int generation) noexcept {
+        return (generation - entry_generation(data)) & (GENERATIONS - 1);
+    }
+
+    static void reset_bucket(Bucket& bucket, std::uint32_t epoch) noexcept {
+        for (TableEntry& entry : bucket.entries) {
+            entry.check.store(0, ORDER);
+            entry.move.store(0, ORDER);
+            entry.data.store(0, ORDER);
+        }
+
+        bucket.epoch.store(epoch, ORDER);
+    }
+
     TranspositionTable::~TranspositionTable() noexcept {
-        delete[] m_entries;
+        delete[] m_buckets;
     }
 
     void TranspositionTable::allocate(std::size_t size_bytes) {
-        delete[] m_entries;
+        deallocate();
+
+        std::size_t size {1};
+
+        while (size * 2 <= size_bytes / sizeof(Bucket)) {
+            size *= 2;
+        }
+
+        m_buckets = new Bucket[size];
+        m_size = size;
+        m_epoch = 0;
+    }
 
-        m_size = size_bytes / sizeof(TableEntry);
-        m_entries = new TableEntry[m_size];
+    void TranspositionTable::deallocate() noexcept {
+        delete[] m_buckets;
+        m_buckets = nullptr;
+        m_size = 0;
     }
 
     void TranspositionTable::clear() noexcept {
-        for (std::size_t i {0}; i < m_size; i++) {
-            m_entries[i] = {};
+        m_epoch++;
+
+        // Only on overflow, when old buckets could seem new again, do the actual work
+        if (m_epoch == 0) {
+            for (std::size_t i {0}; i < m_size; i++) {
+                reset_bucket(m_buckets[i], 0);
+            }
         }
     }
 
+    int TranspositionTable::hashfull(int sequence) const noexcept {
+        const int generation {sequence & (GENERATIONS - 1)};
+        const std::size_t size {std::min(m_size, static_cast<std::size_t>(1000 / Bucket::SIZE))};
+
+        int result {0};
+
+        for (std::size_t i {0}; i < size; i++) {
+            if (m_buckets[i].epoch.load(ORDER) != m_epoch) {
+                continue;
+            }
+
+            for (const TableEntry& entry : m_buckets[i].entries) {
+                const std::uint32_t data {entry.data.load(ORDER)};
+                result += !is_empty(data) && entry_generation(data) == generation;
+            }
+        }
+
+        return size > 0 ? static_cast<int>(result * 1000 / (size * Bucket::SIZE)) : 0;
+    }
+
     void TranspositionTable::store(const game::Position& position, int depth, int sequence, Flag flag, evaluation::Eval eval, game::Move move) noexcept {
-        store(zobrist::instance.hash(position), game::signature(position), depth, sequence, flag, eval, move);
+        store(zobrist::instance.hash(position), depth, sequence, flag, eval, move);
     }
 
-    void TranspositionTable::store(Key key, Signature signature, int depth, int sequence, Flag flag, evaluation::Eval eval, game::Move move) noexcept {
+    void TranspositionTable::store(Key key, int depth, int sequence, Flag flag, evaluation::Eval eval, game::Move move) noexcept {
         assert(m_size != 0);
 
-        TableEntry& entry {m_entries[key % m_size]};
+        std::int16_t compacted_eval {};
+
+        if (!compact_eval(eval, compacted_eval)) {
+            return;
+        }
+
+        const int generation {sequence & (GENERATIONS - 1)};
+
+        Bucket& bucket {find_bucket(key)};
+
+        // The bucket is left over from before the last clear
+        if (bucket.epoch.load(ORDER) != m_epoch) {
+            reset_bucket(bucket, m_epoch);
+        }
+
+        TableEntry* replaced_entry {nullptr};
+        int replaced_score {std::numeric_limits<int>::max()};
+
+        for (TableEntry& entry : bucket.entries) {
+            const std::uint32_t data {entry.data.load(ORDER)};
+
+            // Entries are never emptied one by one, so the rest of them are empty too
+            if (is_empty(data)) {
+                replaced_entry = &entry;
+                break;
+            }
+
+            if (entry.check.load(ORDER) == entry_check(key, entry.move.load(ORDER), data)) {
+                // Scheme "replace if same depth or deeper, or entry is old"
 
-        // Scheme "replace if same depth or deeper, or entry is old"
+                if (entry_depth(data) <= depth || entry_generation(data) != generation) {
+                    replaced_entry = &entry;
+                    break;
+                }
+
+                return;
+            }
 
-        if (entry.depth <= depth || sequence != entry.sequence) {
-            entry.signature = signature;
-            entry.move = move;
-            entry.flag = flag;
-            entry.eval = eval;
-            entry.depth = depth;
-            entry.sequence = sequence;
+            // Otherwise replace the shallowest and oldest entry
+            const int score {entry_depth(data) - entry_age(data, generation) * AGE_WEIGHT};
+
+            if (score < replaced_score) {
+                replaced_entry = &entry;
+                replaced_score = score;
+            }
         }
+
+        assert(replaced_entry != nullptr);
+
+        const std::uint32_t compacted_move {compact_move(move)};
+        const std::uint32_t data {pack_data(compacted_eval, depth, flag, generation)};
+
+        // Any other thread may be writing the same entry; whatever words are left, they have to match
+        replaced_entry->check.store(entry_check(key, compacted_move, data), ORDER);
+        replaced_entry->move.store(compacted_move, ORDER);
+        replaced_entry->data.store(data, ORDER);
     }
 
     TableEntryResult TranspositionTable::load(const game::Position& position, int depth, evaluation::Eval alpha, evaluation::Eval beta) const noexcept {
-        return load(zobrist::instance.hash(position), game::signature(position), depth, alpha, beta);
+        return load(zobrist::instance.hash(position), depth, alpha, beta);
     }
 
-    TableEntryResult TranspositionTable::load(Key key, Signature signature, int depth, evaluation::Eval alpha, evaluation::Eval beta) const noexcept {
+    TableEntryResult TranspositionTable::load(Key key, int depth, evaluation::Eval alpha, evaluation::Eval beta) const noexcept {
         assert(m_size != 0);
 
-        const TableEntry& entry {m_entries[key % m_size]};
+        const Bucket& bucket {find_bucket(key)};
 
-        if (entry.signature != signature) {
+        if (bucket.epoch.load(ORDER) != m_epoch) {
             return std::make_pair(evaluation::UNKNOWN, game::NULL_MOVE);
         }
 
-        if (entry.depth >= depth) {
-            if (entry.flag == Flag::Exact) {
-                return std::make_pair(entry.eval, game::NULL_MOVE);
+        for (const TableEntry& entry : bucket.entries) {
+            const std::uint32_t check {entry.check.load(ORDER)};
+            const std::uint32_t move {entry.move.load(ORDER)};
+            const std::uint32_t data {entry.data.load(ORDER)};
+
+            if (is_empty(data)) {
+                break;
             }
 
-            if (entry.flag == Flag::Alpha && entry.eval <= alpha) {
-                return std::make_pair(alpha, game::NULL_MOVE);
+            // Either a different position, or a torn entry
+            if (check != entry_check(key, move, data)) {
+                continue;
             }
 
-            if (entry.flag == Flag::Beta && entry.eval >= beta) {
-                return std::make_pair(beta, game::NULL_MOVE);
+            if (entry_depth(data) >= depth) {
+                const evaluation::Eval eval {expand_eval(entry_eval(data))};
+                const Flag flag {entry_flag(data)};
+
+                if (flag == Flag::Exact) {
+                    return std::make_pair(eval, game::NULL_MOVE);
+                }
+
+                if (flag == Flag::Alpha && eval <= alpha) {
+                    return std::make_pair(alpha, game::NULL_MOVE);
+                }
+
+                if (flag == Flag::Beta && eval >= beta) {
+                    return std::make_pair(beta, game::NULL_MOVE);
+                }
             }
+
+            // Also return the hash move to be used in reordering
+            return std::make_pair(evaluation::UNKNOWN, expand_move(move));
         }
 
-        // Also return the hash move to be used in reordering
-        return std::make_pair(evaluation::UNKNOWN, entry.move);
+        return std::make_pair(evaluation::UNKNOWN, game::NULL_MOVE);
     }
 }
@@ -1,18 +1,20 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <atomic>
 
 #include "game.hpp"
 #include "evaluation.hpp"
 
 // https://www.chessprogramming.org/Node_Types
-// https://stackoverflow.com/questions/18439520/is-there-a-128-bit-integer-in-c
 // https://web.archive.org/web/20071031100051/http://www.brucemo.com/compchess/programming/hashing.htm
 // https://www.chessprogramming.org/Transposition_Table#KeyCollisions
+// https://www.chessprogramming.org/Transposition_Table#Bucket_Systems
+// https://www.chessprogramming.org/Shared_Hash_Table#Lockless
 
 namespace transposition_table {
     using Key = game::PositionKey;
-    using Signature = game::PositionSignature;
 
     enum class Flag : int {
         Exact,
@@ -20,16 +22,29 @@ namespace transposition_table {
         Alpha
     };
 
+    // Entries are read and written by many threads without locks
+    // The check word is the upper half of the key xored with the other two words, so that an entry
+    // torn by concurrent stores doesn't match any key
     struct TableEntry {
-        // signature and depth must be initialized to 0
-        Signature signature {0};
-        game::Move move {};  // "Best move"
-        Flag flag {};  // Type of evaluation
-        evaluation::Eval eval {};
-        int depth {0};
-        int sequence {};  // Search number
+        // An entry is empty when its bound bits are 0
+        std::atomic<std::uint32_t> check {0};  // The lower half of the key is the index of the bucket
+        std::atomic<std::uint32_t> move {0};  // "Best move", compacted
+        std::atomic<std::uint32_t> data {0};  // Eval (16 bits), depth (8 bits), bound as flag + 1 (2 bits), generation (6 bits)
     };
 
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+    static_assert(sizeof(TableEntry) == 12);
+
+    // Entries that share the same cache line
+    struct alignas(64) Bucket {
+        static constexpr int SIZE {5};
+
+        TableEntry entries[SIZE] {};
+        std::atomic<std::uint32_t> epoch {0};  // The entries are empty, if this is not the epoch of the table
+    };
+
+    static_assert(sizeof(Bucket) == 64);
+
     using TableEntryResult = std::pair<evaluation::Eval, game::Move>;
 
     class TranspositionTable {
@@ -42,20 +57,33 @@ namespace transposition_table {
         TranspositionTable(TranspositionTable&&) = delete;
         TranspositionTable& operator=(TranspositionTable&&) = delete;
 
+        // The number of buckets is rounded down to a power of two
         void allocate(std::size_t size_bytes);
+        void deallocate() noexcept;
+
+        // Constant time; buckets are emptied only when they are written to again
         void clear() noexcept;
 
         void store(const game::Position& position, int depth, int sequence, Flag flag, evaluation::Eval eval, game::Move move) noexcept;
-        void store(Key key, Signature signature, int depth, int sequence, Flag flag, evaluation::Eval eval, game::Move move) noexcept;
+        void store(Key key, int depth, int sequence, Flag flag, evaluation::Eval eval, game::Move move) noexcept;
         TableEntryResult load(const game::Position& position, int depth, evaluation::Eval alpha, evaluation::Eval beta) const noexcept;
-        TableEntryResult load(Key key, Signature signature, int depth, evaluation::Eval alpha, evaluation::Eval beta) const noexcept;
+        TableEntryResult load(Key key, int depth, evaluation::Eval alpha, evaluation::Eval beta) const noexcept;
 
+        // Number of entries
         std::size_t size() const noexcept {
-            return m_size;
+            return m_size * Bucket::SIZE;
         }
+
+        // Permille of entries written by this search, estimated from the first ones
+        int hashfull(int sequence) const noexcept;
     private:
-        TableEntry* m_entries {nullptr};
-        std::size_t m_size {0};
+        Bucket& find_bucket(Key key) const noexcept {
+            return m_buckets[key & (m_size - 1)];
+        }
+
+        Bucket* m_buckets {nullptr};
+        std::size_t m_size {0};  // Number of buckets
+        std::uint32_t m_epoch {0};  // Incremented on every clear
     };
 
     constexpr std::size_t mib_to_bytes(std::size_t mib) noexcept {
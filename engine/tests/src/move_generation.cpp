@@ -4,6 +4,8 @@
 #include <gtest/gtest.h>
 #include <moves.hpp>
 #include <game.hpp>
+#include <zobrist.hpp>
+#include <evaluation_terms.hpp>
 
 static std::uint64_t count_moves(int depth, const game::GamePosition& position) {
     std::uint64_t total_moves {0};
@@ -16,7 +18,7 @@ static std::uint64_t count_moves(int depth, const game::GamePosition& position)
 
     for (const game::Move move : moves) {
         game::GamePosition new_position {position};
-        game::play_move(new_position, move);
+        game::play_move_bare(new_position, move);
 
         total_moves += count_moves(depth - 1, new_position);
     }
@@ -31,6 +33,68 @@ static std::uint64_t test_moves_from_position(int depth, const char* fen_string)
     return count_moves(depth, position);
 }
 
+static bool same_position(const game::GamePosition& position1, const game::GamePosition& position2) {
+    return (
+        position1.board == position2.board &&
+        position1.black == position2.black &&
+        position1.white == position2.white &&
+        position1.kings == position2.kings &&
+        position1.player == position2.player &&
+        position1.plies_without_advancement == position2.plies_without_advancement &&
+        position1.key == position2.key &&
+        position1.signature == position2.signature &&
+        position1.terms == position2.terms
+    );
+}
+
+static bool make_unmake_moves(int depth, game::GamePosition& position) {
+    if (depth == 0) {
+        return true;
+    }
+
+    const auto moves {moves::generate_moves(position)};
+
+    for (const game::Move move : moves) {
+        const game::GamePosition old_position {position};
+
+        game::GamePosition new_position {position};
+        game::play_move(new_position, move);
+
+        game::MoveUndo undo;
+        game::make_move(position, move, undo);
+
+        if (!same_position(position, new_position)) {
+            return false;
+        }
+
+        // The terms are updated incrementally
+        if (!(position.terms == evaluation_terms::compute(position))) {
+            return false;
+        }
+
+        if (!make_unmake_moves(depth - 1, position)) {
+            return false;
+        }
+
+        game::unmake_move(position, move, undo);
+
+        if (!same_position(position, old_position)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool test_make_unmake_from_position(int depth, const char* fen_string) {
+    zobrist::instance.initialize();
+
+    game::GamePosition position;
+    game::set_position(position, fen_string);
+
+    return make_unmake_moves(depth, position);
+}
+
 static const char* FEN_STRING {"B:B1,2,3,4,5,6,7,8,9,10,11,12:W21,22,23,24,25,26,27,28,29,30,31,32"};
 
 // https://oeis.org/A133046/list
@@ -96,3 +160,12 @@ static const char* FEN_STRING {"B:B1,2,3,4,5,6,7,8,9,10,11,12:W21,22,23,24,25,26
         ASSERT_EQ(test_moves_from_position(15, FEN_STRING), 36'263'167'175ul);
     }
 #endif
+
+TEST(move_generation, make_unmake_start) {
+    ASSERT_TRUE(test_make_unmake_from_position(8, FEN_STRING));
+}
+
+TEST(move_generation, make_unmake_kings) {
+    ASSERT_TRUE(test_make_unmake_from_position(8, "W:B1,2,3,26,18,17,25:WK30,28"));
+    ASSERT_TRUE(test_make_unmake_from_position(8, "B:BK1,K2,14,15:WK30,K31,18,19,22"));
+}
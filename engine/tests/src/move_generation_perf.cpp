@@ -16,7 +16,7 @@ static void generate_moves(int depth, const game::GamePosition& position) {
 
     for (const game::Move move : moves) {
         game::GamePosition new_position {position};
-        game::play_move(new_position, move);
+        game::play_move_bare(new_position, move);
 
         generate_moves(depth - 1, new_position);
     }
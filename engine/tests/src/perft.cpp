@@ -0,0 +1,79 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include <perft.hpp>
+#include <game.hpp>
+#include <zobrist.hpp>
+#include <transposition_table.hpp>
+
+/*
+    perft [--depth N] [--threads N] [--hash MiB] [--position FEN] [--divide]
+*/
+
+int main(int argc, char** argv) {
+    int depth {11};
+    int threads {1};
+    std::size_t hash_mib {0};
+    std::string fen_string {"B:B1,2,3,4,5,6,7,8,9,10,11,12:W21,22,23,24,25,26,27,28,29,30,31,32"};
+    bool divide {false};
+
+    try {
+        for (int i {1}; i < argc; i++) {
+            if (std::strcmp(argv[i], "--divide") == 0) {
+                divide = true;
+                continue;
+            }
+
+            if (i + 1 == argc) {
+                std::cerr << "Missing value for " << argv[i] << '\n';
+                return 1;
+            }
+
+            if (std::strcmp(argv[i], "--depth") == 0) {
+                depth = std::stoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--threads") == 0) {
+                threads = std::stoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--hash") == 0) {
+                hash_mib = std::stoul(argv[++i]);
+            } else if (std::strcmp(argv[i], "--position") == 0) {
+                fen_string = argv[++i];
+            } else {
+                std::cerr << "Unknown argument " << argv[i] << '\n';
+                return 1;
+            }
+        }
+    } catch (...) {  // stoi, stoul
+        std::cerr << "Invalid argument\n";
+        return 1;
+    }
+
+    // The hash table needs the Zobrist keys
+    zobrist::instance.initialize();
+
+    game::GamePosition position;
+
+    try {
+        game::set_position(position, fen_string);
+    } catch (...) {
+        std::cerr << "Invalid position\n";
+        return 1;
+    }
+
+    const auto result {perft::perft(position, depth, threads, transposition_table::mib_to_bytes(hash_mib))};
+
+    if (divide) {
+        for (const auto& [move, nodes] : result.root_moves) {
+            std::cout << game::move_to_string(move) << ' ' << nodes << '\n';
+        }
+    }
+
+    std::cout << "depth " << depth << '\n';
+    std::cout << "nodes " << result.nodes << '\n';
+    std::cout << "time " << result.time << '\n';
+    std::cout << "nps " << static_cast<std::uint64_t>(perft::nodes_per_second(result)) << '\n';
+
+    return 0;
+}
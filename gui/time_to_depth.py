@@ -0,0 +1,85 @@
+#! /usr/bin/env python3
+
+import sys
+import json
+import time
+
+from common import checkers_engine
+
+# Measure how long the engine takes to reach a fixed depth on every position of a match file,
+# for every thread count, so that the multi-threaded search scaling can be compared
+
+# time_to_depth.py <engine> <match file> <depth> <threads 1> [<threads 2> ...]
+
+
+def wait_for(engine: checkers_engine.CheckersEngine, message_name: str) -> str:
+    while True:
+        message = engine.receive(1.0)
+
+        if message.strip().startswith(message_name):
+            return message
+
+
+def time_to_depth(engine: checkers_engine.CheckersEngine, positions: list[str], depth: int, threads: int) -> float:
+    engine.send(f"SETPARAMETER threads {threads}")
+
+    total = 0.0
+
+    for position in positions:
+        engine.send(f"NEWGAME {position}")
+        engine.send("GETNAME")
+        wait_for(engine, "NAME")
+
+        begin = time.monotonic()
+        engine.send(f"GO maxdepth {depth} dontplaymove")
+        wait_for(engine, "BESTMOVE")
+        total += time.monotonic() - begin
+
+    return total
+
+
+def main(args: list[str]) -> int:
+    if len(args) < 5:
+        print("Usage: time_to_depth.py <engine> <match file> <depth> <threads 1> [<threads 2> ...]", file=sys.stderr)
+        return 1
+
+    try:
+        with open(args[2], "r") as file:
+            positions: list[str] = json.load(file)["positions"]
+    except Exception as err:
+        print(f"Could not read match file: {err}", file=sys.stderr)
+        return 1
+
+    depth = int(args[3])
+    thread_counts = [int(arg) for arg in args[4:]]
+
+    engine = checkers_engine.CheckersEngine()
+
+    try:
+        engine.start(args[1])
+        wait_for(engine, "READY")
+        engine.send("INIT")
+        engine.send("SETPARAMETER use_book false")
+
+        base_time = None
+
+        for threads in thread_counts:
+            total = time_to_depth(engine, positions, depth, threads)
+
+            if base_time is None:
+                base_time = total
+
+            print(f"threads {threads} time {total:.3f} speedup {base_time / total:.2f}")
+
+        engine.send("QUIT")
+        engine.stop()
+    except checkers_engine.CheckersEngineError as err:
+        print(f"Engine error: {err}", file=sys.stderr)
+        engine.stop(True)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))